@@ -141,7 +141,7 @@ int main(void) {
 
     // 6. 并行算法
     std::vector<int> vec{1, 5, 6, -10, 11, 0, 7, 8, 1, 3, 9, 0, -3};
-    // 编译器后端要支持
+    // 编译器后端要支持，不依赖后端的线程池版本见26range/02parallel_algo
     // std::sort(std::execution::par, vec.begin(), vec.end());
 
     // 7. 几个现代类型
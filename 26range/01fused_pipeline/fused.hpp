@@ -0,0 +1,390 @@
+#pragma once
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+// filter -> transform -> fold 的融合
+// 上一级main.cpp里 vec | views::filter | views::transform 之后再fold_left，每个元素都要经过两层迭代器适配器，
+// filter_view的++里是一个依赖数据的分支，选择率在50%附近时分支预测几乎全错，编译器也不会向量化这样的循环。
+// 这里保持管道写法：vec | fused::filter(p) | fused::transform(f) | fused::fold(init, op)
+// 1) filter、transform只是把谓词和函数记下来，连续的filter用&&合并，连续的transform复合成一个函数；
+//    transform之后的filter作用在变换后的值上，这时再套一层stage，每个元素的f只算一次，结果直接交给外层
+// 2) 管道本身仍然是一个range(内部就是views::filter + views::transform)，可以照常用范围for
+// 3) fold时不走迭代器，直接在底层range上跑一个循环，底层是连续内存时用下标循环；
+//    默认和views::filter一样，谓词为真才调用f，filter可以用来保护f(判零、判空指针)
+// 4) fused::transform_unchecked(f)由调用方保证f对任何输入都安全且没有副作用，
+//    这时op有单位元(plus、multiplies、位运算)就写成 acc = op(acc, p(x) ? f(x) : 单位元)，
+//    对每个元素都算f(x)，没有分支，编译器可以向量化；管道里所有transform都是unchecked时才走这条路，
+//    transform之后又有filter(套了stage)时，外层一律按默认方式执行
+namespace fused {
+
+struct always_true {
+    template <typename T>
+    constexpr bool operator()(const T &) const noexcept {
+        return true;
+    }
+};
+
+template <typename Pred>
+struct filter_fn {
+    Pred pred;
+};
+
+template <typename Fn, bool Unchecked = false>
+struct transform_fn {
+    Fn fn;
+};
+
+template <typename Init, typename Op>
+struct fold_fn {
+    Init init;
+    Op op;
+};
+
+template <typename Pred>
+filter_fn<Pred> filter(Pred pred) {
+    return {std::move(pred)};
+}
+
+template <typename Fn>
+transform_fn<Fn> transform(Fn fn) {
+    return {std::move(fn)};
+}
+
+// fn对被过滤掉的元素也会执行
+template <typename Fn>
+transform_fn<Fn, true> transform_unchecked(Fn fn) {
+    return {std::move(fn)};
+}
+
+template <typename Init, typename Op = std::plus<>>
+fold_fn<Init, Op> fold(Init init, Op op = {}) {
+    return {std::move(init), std::move(op)};
+}
+
+namespace detail {
+
+// op的单位元，有单位元时才能把"跳过"写成"加上单位元"
+template <typename Op, typename T>
+struct identity_element {};
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+struct identity_element<std::plus<>, T> {
+    static constexpr T value = T(0);
+};
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+struct identity_element<std::plus<T>, T> : identity_element<std::plus<>, T> {};
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+struct identity_element<std::multiplies<>, T> {
+    static constexpr T value = T(1);
+};
+
+template <typename T>
+    requires std::is_arithmetic_v<T>
+struct identity_element<std::multiplies<T>, T> : identity_element<std::multiplies<>, T> {};
+
+template <std::integral T>
+struct identity_element<std::bit_or<>, T> {
+    static constexpr T value = T(0);
+};
+
+template <std::integral T>
+struct identity_element<std::bit_xor<>, T> {
+    static constexpr T value = T(0);
+};
+
+template <std::integral T>
+struct identity_element<std::bit_and<>, T> {
+    static constexpr T value = static_cast<T>(~T(0));
+};
+
+template <typename Op, typename T>
+concept has_identity = requires { identity_element<Op, T>::value; };
+
+// keep ? y : other，整数用掩码计算，避免编译器在-O2下把条件表达式又编译回分支
+template <typename Y>
+constexpr Y select(bool keep, Y y, Y other) noexcept {
+    if constexpr (std::integral<Y> && !std::same_as<Y, bool>) {
+        using U = std::make_unsigned_t<Y>;
+        U mask = U(0) - static_cast<U>(keep);
+        return static_cast<Y>((static_cast<U>(y) & mask) | (static_cast<U>(other) & ~mask));
+    } else {
+        return keep ? y : other;
+    }
+}
+
+// 被融合的循环体：一次处理一个元素
+template <bool Unchecked, typename Acc, typename Pred, typename Fn, typename Op, typename X>
+constexpr void step(Acc &acc, Pred &pred, Fn &fn, Op &op, X &&x) {
+    using Y = std::remove_cvref_t<std::invoke_result_t<Fn &, X>>;
+    if constexpr (Unchecked && has_identity<Op, Y>) {
+        Y y = std::invoke(fn, x);
+        bool keep = std::invoke(pred, x);
+        acc = std::invoke(op, std::move(acc), select(keep, y, identity_element<Op, Y>::value));
+    } else {
+        if (std::invoke(pred, x))
+            acc = std::invoke(op, std::move(acc), std::invoke(fn, std::forward<X>(x)));
+    }
+}
+
+template <typename F, typename G>
+struct compose {
+    F f;
+    G g;
+
+    template <typename T>
+    constexpr decltype(auto) operator()(T &&x) const {
+        return std::invoke(g, std::invoke(f, std::forward<T>(x)));
+    }
+};
+
+// 捕获了变量的lambda不能赋值，管道要满足std::ranges::view(要求movable)才能再套一层stage，
+// 和标准库的views一样包一层，赋值时销毁旧值再原地构造
+template <typename T>
+class box {
+  public:
+    box(T t) : v_(std::move(t)) {
+    }
+
+    box(const box &) = default;
+    box(box &&) = default;
+
+    box &operator=(const box &o) {
+        if (this != &o)
+            v_.emplace(*o.v_);
+        return *this;
+    }
+
+    box &operator=(box &&o) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &o)
+            v_.emplace(std::move(*o.v_));
+        return *this;
+    }
+
+    T &operator*() noexcept {
+        return *v_;
+    }
+
+    const T &operator*() const noexcept {
+        return *v_;
+    }
+
+  private:
+    std::optional<T> v_;
+};
+
+} // namespace detail
+
+template <std::ranges::view Inner, typename Pred, typename Fn>
+class stage;
+
+// 底层range V上的"filter(Pred)再transform(Fn)"，Unchecked表示Fn可以对被过滤掉的元素执行
+// 谓词和函数在view_里各有一份，这里再留一份给融合的循环用(transform_view拿不到里面的函数)
+template <std::ranges::view V, typename Pred, typename Fn, bool Unchecked = false>
+class pipeline : public std::ranges::view_interface<pipeline<V, Pred, Fn, Unchecked>> {
+    using view_type = std::ranges::transform_view<std::ranges::filter_view<V, Pred>, Fn>;
+
+  public:
+    pipeline(V base, Pred pred, Fn fn)
+        : pred_(pred), fn_(fn), view_(std::ranges::filter_view(std::move(base), std::move(pred)), std::move(fn)) {
+    }
+
+    auto begin() {
+        return view_.begin();
+    }
+
+    auto end() {
+        return view_.end();
+    }
+
+    // 取出底层range，管道随之失效
+    V base() && {
+        return std::move(view_).base().base();
+    }
+
+    template <typename Q>
+    friend auto operator|(pipeline p, filter_fn<Q> f) {
+        if constexpr (std::is_same_v<Fn, std::identity>) {
+            auto both = [pred = *p.pred_, q = std::move(f.pred)](const auto &x) {
+                return std::invoke(pred, x) && std::invoke(q, x);
+            };
+            return pipeline<V, decltype(both), Fn, Unchecked>(std::move(p).base(), std::move(both), *p.fn_);
+        } else {
+            return stage<pipeline, Q, std::identity>(std::move(p), std::move(f.pred), {});
+        }
+    }
+
+    // 第一个transform决定是否unchecked，之后复合的函数要两者都是unchecked
+    template <typename G, bool U>
+    friend auto operator|(pipeline p, transform_fn<G, U> t) {
+        if constexpr (std::is_same_v<Fn, std::identity>) {
+            return pipeline<V, Pred, G, U>(std::move(p).base(), *p.pred_, std::move(t.fn));
+        } else {
+            using F2 = detail::compose<Fn, G>;
+            return pipeline<V, Pred, F2, Unchecked && U>(std::move(p).base(), *p.pred_, F2{*p.fn_, std::move(t.fn)});
+        }
+    }
+
+    template <typename Init, typename Op>
+    friend auto operator|(pipeline p, fold_fn<Init, Op> f) {
+        return std::move(p).fold(std::move(f.init), std::move(f.op));
+    }
+
+    // 融合后的循环，不经过view_的迭代器
+    template <typename Init, typename Op>
+    auto fold(Init init, Op op) && {
+        using X = std::ranges::range_reference_t<V>;
+        using Acc = std::decay_t<std::invoke_result_t<Op &, Init, std::invoke_result_t<Fn &, X>>>;
+        Acc acc = std::move(init);
+        V base = std::move(*this).base();
+        if constexpr (std::ranges::contiguous_range<V> && std::ranges::sized_range<V>) {
+            auto *data = std::ranges::data(base);
+            auto n = static_cast<std::size_t>(std::ranges::size(base));
+            std::size_t i = 0;
+            // 无分支时，整数上的这些op满足结合律和交换律，拆成lanes个独立的累加器，打破循环间的依赖；
+            // -O3(gcc的-O2不向量化需要尾部处理的循环)时整个循环会被向量化
+            if constexpr (Unchecked && detail::has_identity<Op, Acc> && std::integral<Acc>) {
+                constexpr std::size_t lanes = 8;
+                Acc part[lanes];
+                for (auto &p : part)
+                    p = detail::identity_element<Op, Acc>::value;
+                for (; i + lanes <= n; i += lanes)
+                    for (std::size_t k = 0; k < lanes; ++k)
+                        detail::step<Unchecked>(part[k], *pred_, *fn_, op, data[i + k]);
+                for (auto p : part)
+                    acc = std::invoke(op, std::move(acc), p);
+            }
+            for (; i < n; ++i)
+                detail::step<Unchecked>(acc, *pred_, *fn_, op, data[i]);
+        } else {
+            for (auto &&x : base)
+                detail::step<Unchecked>(acc, *pred_, *fn_, op, std::forward<decltype(x)>(x));
+        }
+        return acc;
+    }
+
+    // 对每个保留下来的元素调用sink(f(x))，外层stage的融合循环用它
+    template <typename Sink>
+    void for_each(Sink &&sink) && {
+        V base = std::move(*this).base();
+        for (auto &&x : base)
+            if (std::invoke(*pred_, x))
+                sink(std::invoke(*fn_, std::forward<decltype(x)>(x)));
+    }
+
+  private:
+    detail::box<Pred> pred_;
+    detail::box<Fn> fn_;
+    view_type view_;
+};
+
+// transform之后的filter(Pred)再transform(Fn)，作用在内层管道Inner产生的值上
+// 融合循环里内层每个元素的函数只算一次，算出的值先过Pred再交给Fn
+template <std::ranges::view Inner, typename Pred, typename Fn>
+class stage : public std::ranges::view_interface<stage<Inner, Pred, Fn>> {
+    using view_type = std::ranges::transform_view<std::ranges::filter_view<Inner, Pred>, Fn>;
+
+  public:
+    stage(Inner inner, Pred pred, Fn fn)
+        : pred_(pred), fn_(fn), view_(std::ranges::filter_view(std::move(inner), std::move(pred)), std::move(fn)) {
+    }
+
+    auto begin() {
+        return view_.begin();
+    }
+
+    auto end() {
+        return view_.end();
+    }
+
+    template <typename Q>
+    friend auto operator|(stage s, filter_fn<Q> f) {
+        if constexpr (std::is_same_v<Fn, std::identity>) {
+            auto both = [pred = *s.pred_, q = std::move(f.pred)](const auto &x) {
+                return std::invoke(pred, x) && std::invoke(q, x);
+            };
+            return stage<Inner, decltype(both), Fn>(std::move(s).inner(), std::move(both), *s.fn_);
+        } else {
+            return stage<stage, Q, std::identity>(std::move(s), std::move(f.pred), {});
+        }
+    }
+
+    // 这一层有filter，unchecked也按默认方式执行
+    template <typename G, bool U>
+    friend auto operator|(stage s, transform_fn<G, U> t) {
+        if constexpr (std::is_same_v<Fn, std::identity>) {
+            return stage<Inner, Pred, G>(std::move(s).inner(), *s.pred_, std::move(t.fn));
+        } else {
+            using F2 = detail::compose<Fn, G>;
+            return stage<Inner, Pred, F2>(std::move(s).inner(), *s.pred_, F2{*s.fn_, std::move(t.fn)});
+        }
+    }
+
+    template <typename Init, typename Op>
+    friend auto operator|(stage s, fold_fn<Init, Op> f) {
+        return std::move(s).fold(std::move(f.init), std::move(f.op));
+    }
+
+    template <typename Init, typename Op>
+    auto fold(Init init, Op op) && {
+        using X = std::ranges::range_reference_t<Inner>;
+        using Acc = std::decay_t<std::invoke_result_t<Op &, Init, std::invoke_result_t<Fn &, X>>>;
+        Acc acc = std::move(init);
+        std::move(*this).for_each(
+            [&](auto &&y) { acc = std::invoke(op, std::move(acc), std::forward<decltype(y)>(y)); });
+        return acc;
+    }
+
+    template <typename Sink>
+    void for_each(Sink &&sink) && {
+        std::move(*this).inner().for_each([&](auto &&y) {
+            if (std::invoke(*pred_, y))
+                sink(std::invoke(*fn_, std::forward<decltype(y)>(y)));
+        });
+    }
+
+  private:
+    // 取出内层管道，stage随之失效
+    Inner inner() && {
+        return std::move(view_).base().base();
+    }
+
+    detail::box<Pred> pred_;
+    detail::box<Fn> fn_;
+    view_type view_;
+};
+
+template <std::ranges::viewable_range R, typename Pred>
+auto operator|(R &&r, filter_fn<Pred> f) {
+    using V = std::views::all_t<R>;
+    return pipeline<V, Pred, std::identity>(std::views::all(std::forward<R>(r)), std::move(f.pred), {});
+}
+
+template <std::ranges::viewable_range R, typename Fn, bool U>
+auto operator|(R &&r, transform_fn<Fn, U> t) {
+    using V = std::views::all_t<R>;
+    return pipeline<V, always_true, Fn, U>(std::views::all(std::forward<R>(r)), {}, std::move(t.fn));
+}
+
+// 不是fused管道的range：普通的逐个累加
+template <std::ranges::input_range R, typename Init, typename Op>
+auto operator|(R &&r, fold_fn<Init, Op> f) {
+    using Acc = std::decay_t<std::invoke_result_t<Op &, Init, std::ranges::range_reference_t<R>>>;
+    Acc acc = std::move(f.init);
+    for (auto &&x : r)
+        acc = std::invoke(f.op, std::move(acc), std::forward<decltype(x)>(x));
+    return acc;
+}
+
+} // namespace fused
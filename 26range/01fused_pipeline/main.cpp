@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "fused.hpp"
+
+// std::ranges::fold_left，标准库没有时用范围for代替
+template <typename R, typename T, typename Op>
+T std_fold(R &&r, T init, Op op) {
+#if defined(__cpp_lib_ranges_fold)
+    return std::ranges::fold_left(r, init, op);
+#else
+    for (auto &&x : r)
+        init = op(std::move(init), x);
+    return init;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+    std::vector vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    // 1. 和上一级main.cpp中r1相同的管道，换成fused::后结果一样
+    auto even = [](int x) { return x % 2 == 0; };
+    auto square = [](int x) { return x * x; };
+    auto r1 = vec | fused::filter(even) | fused::transform(square);
+    for (int x : r1)
+        std::cout << x << ' ';
+    std::cout << "\n";
+    std::cout << (vec | fused::filter(even) | fused::transform(square) | fused::fold(0)) << "\n"; // 220
+    std::cout << std_fold(vec | std::views::filter(even) | std::views::transform(square), 0, std::plus{}) << "\n";
+
+    // 2. 连续的filter合并、连续的transform复合，transform之后的filter作用在变换后的值上
+    auto r2 = vec | fused::filter(even) | fused::transform(square) | fused::filter([](int y) { return y > 10; }) |
+              fused::transform([](int y) { return y + 1; });
+    for (int x : r2)
+        std::cout << x << ' '; // 17 37 65 101
+    std::cout << "\n";
+    std::cout << (vec | fused::transform(square) | fused::fold(1LL, std::multiplies<>{})) << "\n";
+    // transform之后的filter不会让transform多算一次：融合的fold里每个元素只调用一次
+    int calls = 0;
+    auto counted = [&calls](int x) {
+        ++calls;
+        return x * x;
+    };
+    std::cout << (vec | fused::transform(counted) | fused::filter([](int y) { return y > 10; }) | fused::fold(0))
+              << ", transform calls " << calls << "\n"; // 371, 10
+    // 不是fused管道时fold退化为普通的逐个累加
+    std::cout << (vec | std::views::take(3) | fused::fold(0)) << "\n"; // 6
+
+    // 3. 和views::filter一样，filter保护后面的transform；transform_unchecked才会对被过滤掉的元素求值
+    std::vector with_zero{0, 1, 2, 5};
+    std::cout << (with_zero | fused::filter([](int x) { return x != 0; }) |
+                  fused::transform([](int x) { return 100 / x; }) | fused::fold(0))
+              << "\n"; // 170
+
+    // 4. 性能：100M个[0, 100)的随机数，过滤掉一部分后平方求和，选择率从0%到100%
+    // 随机数据让filter_view里的分支在选择率50%附近几乎无法预测
+    // fused::transform仍然有这个分支，只省掉迭代器适配器；
+    // unchecked的时间和选择率无关，-O2下是无分支的标量循环，-O3下被向量化
+    {
+        std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+        std::vector<int> data(n);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> dist(0, 99);
+        for (auto &x : data)
+            x = dist(rng);
+
+        std::cout << n << " ints\n";
+        for (int sel : {0, 10, 25, 50, 75, 90, 100}) {
+            auto keep = [sel](int x) { return x < sel; };
+            auto sq = [](int x) { return static_cast<std::int64_t>(x) * x; };
+            std::int64_t a = 0, b = 0, c = 0;
+            auto views_ms = time_ms([&] {
+                a = std_fold(data | std::views::filter(keep) | std::views::transform(sq), std::int64_t{0},
+                             std::plus<>{});
+            });
+            auto fused_ms = time_ms([&] {
+                b = data | fused::filter(keep) | fused::transform(sq) | fused::fold(std::int64_t{0});
+            });
+            auto unchecked_ms = time_ms([&] {
+                c = data | fused::filter(keep) | fused::transform_unchecked(sq) | fused::fold(std::int64_t{0});
+            });
+            std::cout << "selectivity " << sel << "%:\tstd::views " << views_ms << " ms,\tfused " << fused_ms
+                      << " ms,\tunchecked " << unchecked_ms << " ms,\t" << views_ms / unchecked_ms << "x"
+                      << (a == b && a == c ? "" : "  MISMATCH") << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "par_algo.hpp"
+
+int main(int argc, char *argv[]) {
+    thread_pool pool;
+
+    // 1. 上一级main.cpp里的用法换成并行版本
+    {
+        std::vector vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        std::cout << par::fold_left(pool, vec, 0, std::plus{}) << "\n"; // 55
+        std::cout << par::contains(pool, vec, 2) << "\n";                // 1
+        // 3 4 5 6 7中的偶数
+        auto r = vec | std::views::drop(2) | std::views::take(5);
+        std::cout << par::count_if(pool, r, [](int x) { return x % 2 == 0; }) << "\n"; // 2
+
+        std::vector<int> out(vec.size());
+        par::inclusive_scan(pool, vec, out);
+        for (int x : out)
+            std::cout << x << ' ';
+        std::cout << "\n";
+
+        // 累加器类型和元素类型不同：每块从0开始累加长度，块之间用plus合并
+        std::vector<std::string> words{"fold", "left", "on", "strings"};
+        auto len = par::fold_left(
+            pool, words, std::size_t{0}, [](std::size_t acc, const std::string &s) { return acc + s.size(); },
+            std::plus{});
+        std::cout << len << "\n"; // 17
+
+#if defined(__cpp_lib_ranges_zip)
+        // zip：元素是tuple，求点积
+        std::vector x{1, 2, 3};
+        std::vector y{4, 5, 6};
+        auto dot = par::fold_left(
+            pool, std::views::zip(x, y), 0L,
+            [](long acc, const auto &t) { return acc + std::get<0>(t) * std::get<1>(t); }, std::plus{});
+        std::cout << dot << "\n"; // 32
+
+        // zip：按第一列排序，第二列跟着一起移动
+        std::vector a{3, 1, 2};
+        std::vector b{30, 10, 20};
+        par::sort(pool, std::views::zip(a, b));
+        for (auto [x, y] : std::views::zip(a, b))
+            std::cout << x << ":" << y << ' ';
+        std::cout << "\n";
+#endif
+    }
+
+    // 2. 扩展性：线程数从1到N
+    // fold_left、count_if、contains直接在views::iota上计算，不占内存，默认10亿个元素；
+    // transform、sort、inclusive_scan需要实际的数组，默认用十分之一的规模
+    {
+        std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000'000;
+        unsigned max_threads = argc > 2 ? std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+        std::size_t m = n / 10;
+        auto seq = std::views::iota(std::uint64_t{0}, static_cast<std::uint64_t>(n));
+        auto mix = [](std::uint64_t x) { return (x * 0x9E3779B97F4A7C15ULL) >> 40; };
+
+        std::vector<std::uint32_t> data(m), out(m);
+        std::mt19937 rng(42);
+        for (auto &x : data)
+            x = rng();
+
+        std::cout << "hardware threads " << std::thread::hardware_concurrency() << ", iota size " << n
+                  << ", array size " << m << " (ms)\n";
+        std::cout << "threads\tfold_left\tcount_if\tcontains\ttransform\tinclusive_scan\tsort\n";
+        for (unsigned t = 1; t <= max_threads; t *= 2) {
+            thread_pool p(t);
+            std::uint64_t sum = 0;
+            std::size_t cnt = 0;
+            bool has = false;
+            auto copy = data;
+            std::cout << t << "\t" << time_ms([&] {
+                sum = par::fold_left(p, seq | std::views::transform(mix), std::uint64_t{0});
+            }) << "\t\t" << time_ms([&] {
+                cnt = par::count_if(p, seq, [](std::uint64_t x) { return x % 3 == 0; });
+            }) << "\t\t" << time_ms([&] {
+                has = par::contains(p, seq, static_cast<std::uint64_t>(n - 1));
+            }) << "\t\t" << time_ms([&] {
+                par::transform(p, data, out, [](std::uint32_t x) { return x * 3 + 1; });
+            }) << "\t\t" << time_ms([&] {
+                par::inclusive_scan(p, data, out);
+            }) << "\t\t" << time_ms([&] {
+                par::sort(p, copy);
+            }) << "\n";
+            if (cnt != (n + 2) / 3 || !has || !std::ranges::is_sorted(copy))
+                std::cout << "  wrong result (fold " << sum << ")\n";
+        }
+    }
+    return 0;
+}
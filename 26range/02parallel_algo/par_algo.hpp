@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../28multi_thread/05thread_pool/thread_pool.hpp"
+
+// 在05thread_pool上执行的并行range算法：fold_left、transform、count_if、contains、sort、inclusive_scan
+// 上一级main.cpp里的ranges::fold_left是单线程的，25new_stl_func里的std::sort(std::execution::par, ...)
+// 因为缺少TBB后端被注释掉了。这里：
+// 1) 输入是有大小的随机访问range，views::iota、take、drop、transform、zip(c++23)都可以，只用下标访问
+// 2) 按[0, n)切成若干块，每块一个任务提交给线程池，调用线程在latch上等全部完成，第一个异常重新抛出
+// 3) 块数取worker数的4倍，让工作窃取来平衡不均匀的块；每块至少min_chunk个元素，太小的输入直接顺序执行
+// 4) 在线程池自己的worker里调用时顺序执行，避免worker阻塞等待自己的子任务
+namespace par {
+
+template <typename R>
+concept indexable_range = std::ranges::random_access_range<R> && std::ranges::sized_range<R>;
+
+namespace detail {
+
+inline constexpr std::size_t min_chunk = 1 << 14;
+
+inline std::size_t chunk_count(const thread_pool &pool, std::size_t n) {
+    if (pool.in_worker())
+        return 1;
+    return std::max<std::size_t>(1, std::min<std::size_t>(pool.size() * 4, n / min_chunk));
+}
+
+// 把[0, n)均分成chunks块，f(c, begin, end)在线程池上执行，全部完成后返回
+template <typename F>
+void for_each_chunk(thread_pool &pool, std::size_t n, std::size_t chunks, F &&f) {
+    auto bound = [&](std::size_t c) { return n * c / chunks; };
+    if (chunks == 1) {
+        f(std::size_t{0}, std::size_t{0}, n);
+        return;
+    }
+    std::latch done(static_cast<std::ptrdiff_t>(chunks));
+    std::exception_ptr error;
+    std::once_flag once;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        pool.post([&, c] {
+            try {
+                f(c, bound(c), bound(c + 1));
+            } catch (...) {
+                std::call_once(once, [&] { error = std::current_exception(); });
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace detail
+
+// 每块从identity开始用op折叠自己的元素，各块的结果再按块的顺序用combine从identity开始合并
+// 要求combine满足结合律且identity是它的单位元；累加器类型可以和元素类型不同，
+// 比如(size_t, const string&)求总长度，或者在zip上求点积，这时combine一般是std::plus
+template <indexable_range R, typename T, typename Op, typename Combine>
+auto fold_left(thread_pool &pool, R &&r, T identity, Op op, Combine combine) {
+    using U = std::decay_t<std::invoke_result_t<Op &, T, std::ranges::range_reference_t<R>>>;
+    static_assert(std::is_convertible_v<std::invoke_result_t<Combine &, U, U>, U>, "combine(U, U) must yield U");
+    auto first = std::ranges::begin(r);
+    auto n = static_cast<std::size_t>(std::ranges::size(r));
+    auto chunks = detail::chunk_count(pool, n);
+    std::vector<std::optional<U>> partial(chunks);
+    detail::for_each_chunk(pool, n, chunks, [&](std::size_t c, std::size_t b, std::size_t e) {
+        if (b == e)
+            return;
+        U acc = std::invoke(op, identity, first[b]);
+        for (auto i = b + 1; i < e; ++i)
+            acc = std::invoke(op, std::move(acc), first[i]);
+        partial[c].emplace(std::move(acc));
+    });
+    U acc = identity;
+    for (auto &p : partial)
+        if (p)
+            acc = std::invoke(combine, std::move(acc), std::move(*p));
+    return acc;
+}
+
+// op本身就是(T, T) -> T的结合运算时，合并也用op
+template <indexable_range R, typename T, typename Op = std::plus<>>
+auto fold_left(thread_pool &pool, R &&r, T identity, Op op = {}) {
+    return par::fold_left(pool, std::forward<R>(r), std::move(identity), op, op);
+}
+
+// out[i] = f(in[i])，out的大小不能小于in
+template <indexable_range In, std::ranges::random_access_range Out, typename F>
+void transform(thread_pool &pool, In &&in, Out &&out, F f) {
+    auto src = std::ranges::begin(in);
+    auto dst = std::ranges::begin(out);
+    auto n = static_cast<std::size_t>(std::ranges::size(in));
+    detail::for_each_chunk(pool, n, detail::chunk_count(pool, n), [&](std::size_t, std::size_t b, std::size_t e) {
+        for (auto i = b; i < e; ++i)
+            dst[i] = std::invoke(f, src[i]);
+    });
+}
+
+template <indexable_range R, typename Pred>
+std::size_t count_if(thread_pool &pool, R &&r, Pred pred) {
+    auto first = std::ranges::begin(r);
+    auto n = static_cast<std::size_t>(std::ranges::size(r));
+    std::atomic<std::size_t> total{0};
+    detail::for_each_chunk(pool, n, detail::chunk_count(pool, n), [&](std::size_t, std::size_t b, std::size_t e) {
+        std::size_t k = 0;
+        for (auto i = b; i < e; ++i)
+            k += static_cast<bool>(std::invoke(pred, first[i]));
+        total.fetch_add(k, std::memory_order_relaxed);
+    });
+    return total.load();
+}
+
+// 找到后其他块每处理4096个元素检查一次标志，尽快退出
+template <indexable_range R, typename T>
+bool contains(thread_pool &pool, R &&r, const T &value) {
+    constexpr std::size_t block = 4096;
+    auto first = std::ranges::begin(r);
+    auto n = static_cast<std::size_t>(std::ranges::size(r));
+    std::atomic<bool> found{false};
+    detail::for_each_chunk(pool, n, detail::chunk_count(pool, n), [&](std::size_t, std::size_t b, std::size_t e) {
+        for (auto i = b; i < e && !found.load(std::memory_order_relaxed);) {
+            auto stop = std::min(e, i + block);
+            for (; i < stop; ++i) {
+                if (first[i] == value) {
+                    found.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    });
+    return found.load();
+}
+
+// 各块并行排序，再逐轮两两归并，每轮的归并也并行执行
+template <indexable_range R, typename Comp = std::ranges::less>
+    requires std::sortable<std::ranges::iterator_t<R>, Comp>
+void sort(thread_pool &pool, R &&r, Comp comp = {}) {
+    auto first = std::ranges::begin(r);
+    auto n = static_cast<std::size_t>(std::ranges::size(r));
+    auto chunks = detail::chunk_count(pool, n);
+    std::vector<std::size_t> bounds(chunks + 1);
+    for (std::size_t c = 0; c <= chunks; ++c)
+        bounds[c] = n * c / chunks;
+
+    detail::for_each_chunk(pool, chunks, chunks, [&](std::size_t c, std::size_t, std::size_t) {
+        std::ranges::sort(first + bounds[c], first + bounds[c + 1], comp);
+    });
+    while (bounds.size() > 2) {
+        auto pairs = (bounds.size() - 1) / 2;
+        detail::for_each_chunk(pool, pairs, pairs, [&](std::size_t p, std::size_t, std::size_t) {
+            std::ranges::inplace_merge(first + bounds[2 * p], first + bounds[2 * p + 1], first + bounds[2 * p + 2],
+                                       comp);
+        });
+        std::vector<std::size_t> next;
+        for (std::size_t i = 0; i < bounds.size(); i += 2)
+            next.push_back(bounds[i]);
+        if (next.back() != n)
+            next.push_back(n);
+        bounds = std::move(next);
+    }
+}
+
+// 两遍：先并行求每块的和，顺序算出每块的起始偏移，再并行地在块内做前缀和
+template <indexable_range In, std::ranges::random_access_range Out, typename Op = std::plus<>>
+void inclusive_scan(thread_pool &pool, In &&in, Out &&out, Op op = {}) {
+    using T = std::ranges::range_value_t<In>;
+    auto src = std::ranges::begin(in);
+    auto dst = std::ranges::begin(out);
+    auto n = static_cast<std::size_t>(std::ranges::size(in));
+    auto chunks = detail::chunk_count(pool, n);
+    std::vector<std::optional<T>> sums(chunks);
+    detail::for_each_chunk(pool, n, chunks, [&](std::size_t c, std::size_t b, std::size_t e) {
+        if (c + 1 == chunks || b == e)
+            return;
+        T acc = src[b];
+        for (auto i = b + 1; i < e; ++i)
+            acc = std::invoke(op, std::move(acc), src[i]);
+        sums[c].emplace(std::move(acc));
+    });
+    std::vector<std::optional<T>> offset(chunks);
+    for (std::size_t c = 1; c < chunks; ++c) {
+        if (!sums[c - 1])
+            offset[c] = offset[c - 1];
+        else if (offset[c - 1])
+            offset[c].emplace(std::invoke(op, *offset[c - 1], *sums[c - 1]));
+        else
+            offset[c] = sums[c - 1];
+    }
+    detail::for_each_chunk(pool, n, chunks, [&](std::size_t c, std::size_t b, std::size_t e) {
+        if (b == e)
+            return;
+        T acc = offset[c] ? std::invoke(op, *offset[c], src[b]) : T(src[b]);
+        dst[b] = acc;
+        for (auto i = b + 1; i < e; ++i) {
+            acc = std::invoke(op, std::move(acc), src[i]);
+            dst[i] = acc;
+        }
+    });
+}
+
+} // namespace par
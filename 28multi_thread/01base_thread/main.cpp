@@ -92,6 +92,8 @@ int main(void) {
 
     // 2. jthread
     // 1）自动join的，带有stop机制的thread
+    // 注意这种轮询+sleep的写法，request_stop后最坏要等300ms才退出，空闲时也在周期性唤醒
+    // 可被stop_token打断的等待见06stop_wait
     {
         auto work = [](std::stop_token st, int id) {
             while (!st.stop_requested()) {
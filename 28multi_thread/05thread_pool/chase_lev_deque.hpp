@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev 工作窃取双端队列
+// 1) 只有所属线程(owner)可以push/pop底部，其他线程只能从顶部steal
+// 2) owner的push/pop几乎不需要同步，只有队列里只剩一个元素时才和窃取者CAS竞争
+// 3) 内存序参考 Lê et al. "Correct and Efficient Work-Stealing for Weak Memory Models"
+template <typename T>
+class chase_lev_deque {
+    static_assert(std::is_pointer_v<T>, "元素必须是指针，槽位需要原子读写");
+
+    struct ring {
+        explicit ring(std::int64_t cap) : mask_(cap - 1), slots_(new std::atomic<T>[cap]) {
+        }
+
+        std::int64_t capacity() const {
+            return mask_ + 1;
+        }
+
+        T get(std::int64_t i) const {
+            return slots_[i & mask_].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T v) {
+            slots_[i & mask_].store(v, std::memory_order_relaxed);
+        }
+
+        ring *grow(std::int64_t bottom, std::int64_t top) const {
+            auto *r = new ring(capacity() * 2);
+            for (auto i = top; i != bottom; ++i)
+                r->put(i, get(i));
+            return r;
+        }
+
+        std::int64_t mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+  public:
+    // 容量必须是2的幂，满了会自动翻倍
+    explicit chase_lev_deque(std::int64_t cap = 256) : ring_(new ring(cap)) {
+        garbage_.emplace_back(ring_.load(std::memory_order_relaxed));
+    }
+
+    chase_lev_deque(const chase_lev_deque &) = delete;
+    chase_lev_deque &operator=(const chase_lev_deque &) = delete;
+
+    // 仅owner调用
+    void push(T v) {
+        auto b = bottom_.load(std::memory_order_relaxed);
+        auto t = top_.load(std::memory_order_acquire);
+        auto *r = ring_.load(std::memory_order_relaxed);
+        if (b - t > r->capacity() - 1) {
+            // 旧数组可能还在被窃取者读取，不能立即释放，等析构时统一回收
+            r = r->grow(b, t);
+            garbage_.emplace_back(r);
+            ring_.store(r, std::memory_order_release);
+        }
+        r->put(b, v);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // 仅owner调用，LIFO，刚push的任务缓存还是热的
+    T pop() {
+        auto b = bottom_.load(std::memory_order_relaxed) - 1;
+        auto *r = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // 空队列，恢复bottom
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T v = r->get(b);
+        if (t == b) {
+            // 最后一个元素，和窃取者竞争
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                v = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return v;
+    }
+
+    // 任意线程调用，FIFO，从顶部偷最老的任务
+    // 竞争失败也返回nullptr，调用方去试下一个受害者即可
+    T steal() {
+        auto t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        auto *r = ring_.load(std::memory_order_acquire);
+        T v = r->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return v;
+    }
+
+    bool empty() const {
+        auto b = bottom_.load(std::memory_order_relaxed);
+        auto t = top_.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+  private:
+    // top被窃取者频繁CAS，bottom被owner频繁写，分开到不同的缓存行避免伪共享
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::atomic<ring *> ring_;
+    std::vector<std::unique_ptr<ring>> garbage_;
+};
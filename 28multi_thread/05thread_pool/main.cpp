@@ -0,0 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <latch>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "thread_pool.hpp"
+using namespace std::chrono_literals;
+
+// 并行求和，任务内部再拆分子任务，子任务进入worker自己的Chase-Lev队列
+void parallel_sum(thread_pool &pool, const std::vector<int> &v, std::size_t beg, std::size_t end,
+                  std::atomic<long long> &sum, std::latch &done) {
+    if (end - beg <= 1024) {
+        long long s = 0;
+        for (auto i = beg; i < end; ++i)
+            s += v[i];
+        sum += s;
+        done.count_down(static_cast<std::ptrdiff_t>(end - beg));
+        return;
+    }
+    auto mid = beg + (end - beg) / 2;
+    pool.post([&, mid, end] { parallel_sum(pool, v, mid, end, sum, done); });
+    parallel_sum(pool, v, beg, mid, sum, done);
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 基本用法，submit返回future
+    {
+        thread_pool pool(4);
+        auto f1 = pool.submit([] { return 42; });
+        auto f2 = pool.submit([](int a, int b) { return a + b; }, 1, 2);
+        std::cout << f1.get() << ", " << f2.get() << "\n";
+    }
+
+    // 2. 和jthread一样的协作取消
+    // 任务的第一个参数是std::stop_token时，池会传入自己的token
+    {
+        thread_pool pool(2);
+        auto work = [](std::stop_token st, int id) {
+            int n = 0;
+            while (!st.stop_requested()) {
+                ++n;
+                std::this_thread::yield();
+            }
+            std::cout << "Task " << id << " stopped\n";
+            return n;
+        };
+        auto fut = pool.submit(work, 42);
+        std::this_thread::sleep_for(100ms);
+        pool.request_stop();
+        fut.get();
+    }
+
+    // 3. 挂到外部stop_source，stop_callback负责转发停止请求
+    {
+        std::stop_source src;
+        std::stop_callback cb(src.get_token(), [] { std::cout << "callback: stop_requested!\n"; });
+
+        thread_pool pool(2, src.get_token());
+        auto fut = pool.submit([](std::stop_token st) {
+            while (!st.stop_requested())
+                std::this_thread::yield();
+            return 7;
+        });
+        std::this_thread::sleep_for(100ms);
+        src.request_stop();
+        std::cout << fut.get() << "\n";
+    }
+
+    // 4. 任务内部继续拆分任务，空闲worker从别人的队列里窃取
+    {
+        thread_pool pool;
+        std::vector<int> v(1 << 20, 1);
+        std::atomic<long long> sum = 0;
+        std::latch done(static_cast<std::ptrdiff_t>(v.size()));
+        pool.post([&] { parallel_sum(pool, v, 0, v.size(), sum, done); });
+        done.wait();
+        std::cout << "sum = " << sum << "\n";
+    }
+
+    // 5. benchmark: 1M个小任务，线程池 vs 每个任务一个jthread
+    {
+        const int n = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<long long> counter = 0;
+        auto tiny = [&counter] { counter.fetch_add(1, std::memory_order_relaxed); };
+
+        auto pool_post_ms = time_ms([&] {
+            thread_pool pool(hw);
+            for (int i = 0; i < n; ++i)
+                pool.post(tiny);
+            // 析构时排空队列并join
+        });
+
+        auto pool_future_ms = time_ms([&] {
+            thread_pool pool(hw);
+            std::vector<std::future<void>> futs;
+            futs.reserve(n);
+            for (int i = 0; i < n; ++i)
+                futs.push_back(pool.submit(tiny));
+            for (auto &f : futs)
+                f.get();
+        });
+
+        // 每次最多同时hw个线程，避免把系统线程数打爆
+        auto jthread_ms = time_ms([&] {
+            std::vector<std::jthread> ts;
+            ts.reserve(hw);
+            for (int i = 0; i < n; ++i) {
+                ts.emplace_back(tiny);
+                if (ts.size() == hw)
+                    ts.clear();
+            }
+        });
+
+        std::cout << "tasks: " << n << ", threads: " << hw << "\n";
+        std::cout << "pool post:      " << pool_post_ms << " ms\n";
+        std::cout << "pool submit:    " << pool_future_ms << " ms\n";
+        std::cout << "jthread/task:   " << jthread_ms << " ms\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chase_lev_deque.hpp"
+
+// 工作窃取线程池
+// 1) 每个worker一个Chase-Lev队列，worker内部提交的任务直接压入自己的队列
+// 2) 外部线程提交的任务进入全局注入队列(mutex保护)
+// 3) worker取任务顺序：自己队列(LIFO) -> 全局队列 -> 随机窃取其他worker(FIFO)
+// 4) 没有任务时在atomic上wait休眠，不占CPU
+// 5) 取消沿用jthread的模型：第一个参数是std::stop_token的任务会拿到池的token
+class thread_pool {
+    struct task_base {
+        virtual ~task_base() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename F>
+    struct task final : task_base {
+        template <typename U>
+        explicit task(U &&f) : f_(std::forward<U>(f)) {
+        }
+        void run() override {
+            f_();
+        }
+        F f_;
+    };
+
+    struct worker {
+        chase_lev_deque<task_base *> deque_;
+        std::jthread thread_;
+    };
+
+    struct context {
+        thread_pool *pool;
+        unsigned index;
+    };
+
+    // 判断任务是否接受stop_token，规则和std::jthread一致
+    template <typename F, typename... Args>
+    static constexpr bool takes_stop_token_v =
+        std::is_invocable_v<std::decay_t<F>, std::stop_token, std::decay_t<Args>...>;
+
+    template <typename F, typename... Args>
+    struct result {
+        using type = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+    };
+
+    template <typename F, typename... Args>
+        requires takes_stop_token_v<F, Args...>
+    struct result<F, Args...> {
+        using type = std::invoke_result_t<std::decay_t<F>, std::stop_token, std::decay_t<Args>...>;
+    };
+
+  public:
+    template <typename F, typename... Args>
+    using result_t = typename result<F, Args...>::type;
+
+    explicit thread_pool(unsigned n = std::max(1u, std::thread::hardware_concurrency())) : workers_(n) {
+        for (unsigned i = 0; i < n; ++i)
+            workers_[i].thread_ = std::jthread([this, i] { run_worker(i); });
+    }
+
+    // 挂到外部的stop_source上，外部请求停止时池内任务一并收到，和main中stop_callback的用法一样
+    thread_pool(unsigned n, std::stop_token outer) : thread_pool(n) {
+        forward_stop_.emplace(std::move(outer), [this] { stop_.request_stop(); });
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    // 和jthread一样：析构时先request_stop再join
+    // 已经排队的任务仍然会执行(拿到的是已停止的token)，保证future不会broken_promise
+    ~thread_pool() {
+        forward_stop_.reset();
+        stop_.request_stop();
+        done_.store(true, std::memory_order_seq_cst);
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        epoch_.notify_all();
+        for (auto &w : workers_)
+            w.thread_.join();
+    }
+
+    // 提交任务，返回future
+    template <typename F, typename... Args>
+    auto submit(F &&f, Args &&...args) -> std::future<result_t<F, Args...>> {
+        using R = result_t<F, Args...>;
+        // 和thread一样对参数退化拷贝，需要引用请使用std::ref
+        std::packaged_task<R()> pt(
+            [this, f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable -> R {
+                if constexpr (takes_stop_token_v<F, Args...>)
+                    return std::invoke(std::move(f), stop_.get_token(), std::move(args)...);
+                else
+                    return std::invoke(std::move(f), std::move(args)...);
+            });
+        auto fut = pt.get_future();
+        post(std::move(pt));
+        return fut;
+    }
+
+    // 不需要返回值时使用，省掉future的共享状态
+    template <typename F>
+    void post(F &&f) {
+        enqueue(new task<std::decay_t<F>>(std::forward<F>(f)));
+    }
+
+    std::stop_source get_stop_source() noexcept {
+        return stop_;
+    }
+
+    std::stop_token get_stop_token() const noexcept {
+        return stop_.get_token();
+    }
+
+    bool request_stop() noexcept {
+        return stop_.request_stop();
+    }
+
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    // 当前线程是否是本池的worker
+    bool in_worker() const noexcept {
+        return current_.pool == this;
+    }
+
+  private:
+    void enqueue(task_base *t) {
+        if (in_worker()) {
+            workers_[current_.index].deque_.push(t);
+        } else {
+            std::lock_guard lg(inject_mtx_);
+            inject_.push_back(t);
+        }
+        // 先改epoch再看有没有人睡，和worker的"先登记再睡"配对，不会丢唤醒
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0)
+            epoch_.notify_one();
+    }
+
+    task_base *find_task(unsigned self, std::uint32_t &seed) {
+        if (auto *t = workers_[self].deque_.pop())
+            return t;
+
+        {
+            std::lock_guard lg(inject_mtx_);
+            if (!inject_.empty()) {
+                auto *t = inject_.front();
+                inject_.pop_front();
+                return t;
+            }
+        }
+
+        // xorshift随机选起点，避免所有worker都去偷同一个
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        auto n = size();
+        for (unsigned k = 0, start = seed % n; k < n; ++k) {
+            auto victim = (start + k) % n;
+            if (victim == self)
+                continue;
+            if (auto *t = workers_[victim].deque_.steal())
+                return t;
+        }
+        return nullptr;
+    }
+
+    void run_worker(unsigned self) {
+        current_ = {this, self};
+        std::uint32_t seed = self * 2654435761u + 1;
+
+        auto run = [](task_base *t) {
+            std::unique_ptr<task_base> owner(t);
+            owner->run();
+        };
+
+        for (;;) {
+            if (auto *t = find_task(self, seed)) {
+                run(t);
+                continue;
+            }
+
+            auto e = epoch_.load(std::memory_order_seq_cst);
+            // 读完epoch再检查一次，期间有人提交的话epoch一定变了
+            if (auto *t = find_task(self, seed)) {
+                run(t);
+                continue;
+            }
+            if (done_.load(std::memory_order_seq_cst))
+                break;
+
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.wait(e, std::memory_order_seq_cst);
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        current_ = {nullptr, 0};
+    }
+
+    std::vector<worker> workers_;
+
+    std::mutex inject_mtx_;
+    std::deque<task_base *> inject_;
+
+    alignas(64) std::atomic<std::uint32_t> epoch_{0};
+    alignas(64) std::atomic<int> sleepers_{0};
+    std::atomic<bool> done_{false};
+
+    std::stop_source stop_;
+    std::optional<std::stop_callback<std::function<void()>>> forward_stop_;
+
+    // 静态存储期，零初始化
+    static inline thread_local context current_;
+};
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+
+#include "stop_wait.hpp"
+using namespace std::chrono_literals;
+
+// 测量一种worker写法：空闲1s内的唤醒次数，以及request_stop到线程退出的延迟
+template <typename Work>
+void measure(std::string_view name, Work work, int rounds) {
+    long long wakeups = 0;
+    double total_us = 0, max_us = 0;
+    for (int i = 0; i < rounds; ++i) {
+        std::atomic<long long> count = 0;
+        std::jthread t(work, std::ref(count));
+        std::this_thread::sleep_for(1s);
+
+        auto beg = std::chrono::steady_clock::now();
+        t.request_stop();
+        t.join();
+        auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - beg).count();
+
+        wakeups += count;
+        total_us += us;
+        max_us = std::max(max_us, us);
+    }
+    std::cout << name << ": wakeups/s = " << double(wakeups) / rounds << ", stop latency avg = " << total_us / rounds
+              << "us, max = " << max_us << "us\n";
+}
+
+int main(void) {
+    // 1. 可打断的睡眠
+    // 原来的写法：sleep_for(300ms)期间看不到stop，最坏要等300ms
+    // 现在的写法：condition_variable_any + stop_token，request_stop立即唤醒
+    {
+        auto work = [](std::stop_token st, int id) {
+            do {
+                std::cout << "Task " << id << " running\n";
+            } while (sleep_for(st, 300ms));
+        };
+
+        std::jthread t(work, 42);
+        std::this_thread::sleep_for(1s);
+        t.request_stop();
+    }
+
+    // 2. 只等停止，不需要周期醒来，空闲时完全不占CPU
+    {
+        std::jthread t([](std::stop_token st) {
+            wait_for_stop(st);
+            std::cout << "stopped\n";
+        });
+        std::this_thread::sleep_for(100ms);
+    }
+
+    // 3. 周期任务
+    {
+        int n = 0;
+        periodic_task task(100ms, [&n] { std::cout << "tick " << ++n << "\n"; });
+        std::this_thread::sleep_for(350ms);
+        // 析构时request_stop并join，不会多等一个周期
+    }
+
+    // 4. 停止延迟和空闲唤醒次数，改造前后对比
+    {
+        const int rounds = 5;
+
+        // 改造前：轮询stop_requested，每300ms醒一次
+        measure(
+            "poll 300ms      ",
+            [](std::stop_token st, std::atomic<long long> &count) {
+                while (!st.stop_requested()) {
+                    ++count;
+                    std::this_thread::sleep_for(300ms);
+                }
+            },
+            rounds);
+
+        // 改造后：仍然每300ms干一次活，但是停止立即生效
+        measure(
+            "cv_any 300ms    ",
+            [](std::stop_token st, std::atomic<long long> &count) {
+                while (sleep_for(st, 300ms))
+                    ++count;
+            },
+            rounds);
+
+        // 改造后：没有周期工作的空闲worker，一次都不醒
+        measure(
+            "wait_for_stop   ",
+            [](std::stop_token st, std::atomic<long long> &) { wait_for_stop(st); },
+            rounds);
+    }
+
+    return 0;
+}
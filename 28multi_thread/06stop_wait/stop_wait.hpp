@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// 可被stop_token打断的等待
+// condition_variable_any的wait系列在c++20新增了stop_token重载，内部注册stop_callback来notify
+// 所以request_stop()后等待方立即醒来，而不是等到下一次轮询
+
+// 1. 可打断的睡眠，被停止时返回false，睡满时返回true
+template <typename Clock, typename Duration>
+bool sleep_until(std::stop_token st, const std::chrono::time_point<Clock, Duration> &tp) {
+    std::mutex m;
+    std::condition_variable_any cv;
+    std::unique_lock lk(m);
+    // 谓词永远为false，只靠超时或者stop返回
+    cv.wait_until(lk, st, tp, [] { return false; });
+    return !st.stop_requested();
+}
+
+template <typename Rep, typename Period>
+bool sleep_for(std::stop_token st, const std::chrono::duration<Rep, Period> &d) {
+    return sleep_until(std::move(st), std::chrono::steady_clock::now() + d);
+}
+
+// 2. 无限期等待直到停止，不需要超时时用atomic::wait更轻量
+// stop_callback在request_stop的线程中执行，负责改值并唤醒
+inline void wait_for_stop(std::stop_token st) {
+    std::atomic<bool> stopped = false;
+    std::stop_callback cb(st, [&] {
+        stopped.store(true);
+        stopped.notify_all();
+    });
+    stopped.wait(false);
+}
+
+// 3. 周期任务，基于可打断睡眠
+// 1) 用sleep_until对齐到绝对时间点，任务本身的耗时不会累积成漂移
+// 2) 析构或request_stop后，正在睡眠的线程立即退出
+// 3) 任务的第一个参数是std::stop_token时会传入，和jthread规则一致
+class periodic_task {
+  public:
+    template <typename F>
+    periodic_task(std::chrono::steady_clock::duration period, F f)
+        : thread_([period, f = std::move(f)](std::stop_token st) mutable {
+              auto next = std::chrono::steady_clock::now() + period;
+              while (sleep_until(st, next)) {
+                  if constexpr (std::is_invocable_v<F &, std::stop_token>)
+                      f(st);
+                  else
+                      f();
+                  next += period;
+                  // 任务跑超了一个周期就跳过错过的时间点，不去补跑
+                  auto now = std::chrono::steady_clock::now();
+                  if (next < now)
+                      next = now + period;
+              }
+          }) {
+    }
+
+    bool request_stop() noexcept {
+        return thread_.request_stop();
+    }
+
+    std::stop_token get_stop_token() const noexcept {
+        return thread_.get_stop_token();
+    }
+
+  private:
+    std::jthread thread_;
+};
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "task_slot.hpp"
+
+// 和01base_thread中的CLASS_LIFETIME_INFO一样的思路，不打印，只计数
+struct lifetime_counter {
+    static inline std::atomic<int> ctor = 0;
+    static inline std::atomic<int> copy = 0;
+    static inline std::atomic<int> move = 0;
+    static inline std::atomic<int> dtor = 0;
+
+    static void reset() {
+        ctor = copy = move = dtor = 0;
+    }
+
+    static void report(std::string_view name) {
+        std::cout << name << ": ctor = " << ctor << ", copy = " << copy << ", move = " << move << ", dtor = " << dtor
+                  << "\n";
+    }
+};
+
+#define CLASS_LIFETIME_COUNT(kind) lifetime_counter::kind.fetch_add(1, std::memory_order_relaxed)
+
+struct A {
+    int m = -1;
+    A(int m) : m(m) {
+        CLASS_LIFETIME_COUNT(ctor);
+    }
+
+    ~A() {
+        CLASS_LIFETIME_COUNT(dtor);
+    }
+
+    A(const A &a) : m(a.m) {
+        CLASS_LIFETIME_COUNT(copy);
+    }
+
+    A(A &&a) : m(a.m) {
+        CLASS_LIFETIME_COUNT(move);
+    }
+};
+
+// 模拟交给worker的大块缓冲区
+struct buffer {
+    std::vector<char> data;
+    explicit buffer(std::size_t n) : data(n, 1) {
+    }
+};
+
+int main(void) {
+    // 1. std::thread的退化拷贝：主线程拷贝到tuple，函数按值接收，子线程再从tuple移动一次
+    {
+        lifetime_counter::reset();
+        A d{0};
+        std::thread t([](A a) { a.m = 1; }, d);
+        t.join();
+        lifetime_counter::report("std::thread(f, d)        ");
+    }
+
+    // 2. 传入临时值：省掉拷贝，但是临时值要移动到tuple里，子线程还是再移动一次
+    {
+        lifetime_counter::reset();
+        std::thread t([](A a) { a.m = 1; }, A{0});
+        t.join();
+        lifetime_counter::report("std::thread(f, A{0})     ");
+    }
+
+    // 3. task_slot：参数在槽内原地构造，子线程拿到的是引用
+    // 修改对子线程之后的主线程可见，join之后读槽内的值是安全的
+    {
+        lifetime_counter::reset();
+        {
+            task_slot<A> slot;
+            slot.emplace(0);
+            slot.launch([](A &a) { a.m = 1; });
+            slot.join();
+            std::cout << "current a: " << std::get<0>(slot.args()).m << "\n";
+        }
+        lifetime_counter::report("task_slot<A>             ");
+    }
+
+    // 4. 槽可重复使用，每次只构造和析构，没有搬运
+    {
+        lifetime_counter::reset();
+        {
+            task_slot<A, int> slot;
+            for (int i = 0; i < 3; ++i) {
+                slot.emplace(i, i * 10);
+                slot.launch([](A &a, int &n) { a.m += n; });
+            }
+        }
+        lifetime_counter::report("task_slot<A, int> x3     ");
+    }
+
+    // 5. 和jthread一样可以接收stop_token
+    {
+        task_slot<int> slot;
+        slot.emplace(0);
+        slot.launch([](std::stop_token st, int &spins) {
+            while (!st.stop_requested())
+                ++spins;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        slot.request_stop();
+        slot.join();
+        std::cout << "spins > 0: " << (std::get<0>(slot.args()) > 0) << "\n";
+    }
+
+    // 6. 大缓冲区交给子线程的耗时
+    {
+        const std::size_t size = 64 << 20;
+        const int rounds = 10;
+        std::atomic<long long> sink = 0;
+        auto consume = [&sink](const buffer &b) { sink += b.data[b.data.size() / 2]; };
+
+        // 主线程准备好缓冲区后交给线程，std::thread会整块拷贝
+        auto copy_ms = time_ms([&] {
+            for (int i = 0; i < rounds; ++i) {
+                buffer b(size);
+                std::thread t(consume, b);
+                t.join();
+            }
+        });
+
+        // 在槽内准备缓冲区，线程直接引用
+        auto slot_ms = time_ms([&] {
+            task_slot<buffer> slot;
+            for (int i = 0; i < rounds; ++i) {
+                slot.emplace(size);
+                slot.launch(consume);
+                slot.join();
+            }
+        });
+
+        std::cout << "buffer " << (size >> 20) << "MB x " << rounds << ": std::thread copy = " << copy_ms
+                  << " ms, task_slot = " << slot_ms << " ms\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// 预分配的任务槽
+// std::thread(f, a)会把a退化拷贝进内部tuple，函数按值接收时子线程还要再移动一次
+// task_slot把参数直接原地构造在槽里，子线程按引用访问，没有任何拷贝和移动
+// 生命周期：参数属于槽，线程属于槽，槽在join之后才析构参数，所以引用一定有效
+// 槽可以重复使用：join后再emplace，内存不用重新分配
+// 和jthread一样，析构、emplace和launch遇到还在运行的线程时先request_stop再join，会阻塞到线程退出
+template <typename... Args>
+class task_slot {
+    using storage_t = std::tuple<Args...>;
+
+  public:
+    task_slot() = default;
+
+    // 线程持有指向槽的引用，禁止拷贝和移动
+    task_slot(const task_slot &) = delete;
+    task_slot &operator=(const task_slot &) = delete;
+
+    ~task_slot() {
+        stop_and_join();
+        reset();
+    }
+
+    // 在槽内原地构造参数，每个实参对应一个参数的构造函数实参
+    template <typename... Us>
+        requires(sizeof...(Us) == sizeof...(Args))
+    storage_t &emplace(Us &&...us) {
+        stop_and_join();
+        reset();
+        ::new (static_cast<void *>(storage_)) storage_t(std::forward<Us>(us)...);
+        engaged_ = true;
+        return args();
+    }
+
+    // 启动线程，参数按左值引用传给f
+    // f的第一个参数是std::stop_token时传入线程自己的token，和jthread一致
+    // 槽里没有参数(还没emplace或已经reset)时抛出std::logic_error
+    template <typename F>
+    void launch(F &&f) {
+        if (!engaged_)
+            throw std::logic_error("task_slot: launch on an empty slot");
+        stop_and_join();
+        thread_ = std::jthread([this, f = std::forward<F>(f)](std::stop_token st) mutable {
+            std::apply(
+                [&](Args &...as) {
+                    if constexpr (std::is_invocable_v<F &, std::stop_token, Args &...>)
+                        std::invoke(f, std::move(st), as...);
+                    else
+                        std::invoke(f, as...);
+                },
+                args());
+        });
+    }
+
+    void join() {
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    bool request_stop() noexcept {
+        return thread_.request_stop();
+    }
+
+    // 提前析构参数，必须在线程结束后调用
+    void reset() noexcept {
+        if (engaged_) {
+            std::destroy_at(std::addressof(args()));
+            engaged_ = false;
+        }
+    }
+
+    bool has_value() const noexcept {
+        return engaged_;
+    }
+
+    // 槽里没有参数时抛出std::logic_error
+    storage_t &args() {
+        if (!engaged_)
+            throw std::logic_error("task_slot: args on an empty slot");
+        return *std::launder(reinterpret_cast<storage_t *>(storage_));
+    }
+
+  private:
+    void stop_and_join() {
+        if (thread_.joinable()) {
+            thread_.request_stop();
+            thread_.join();
+        }
+    }
+
+    alignas(storage_t) std::byte storage_[sizeof(storage_t)];
+    bool engaged_ = false;
+    std::jthread thread_;
+};
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "rcu_cell.hpp"
+#include "seqlock.hpp"
+using namespace std::chrono_literals;
+
+// 02mutex中reader()/writer()保护的是一个int
+// 这里换成多个字段，读到撕裂的数据时能被检查出来
+struct point {
+    long long x = 0, y = 0, z = 0, w = 0;
+};
+
+// 三种保护方式统一成load/update接口
+struct shared_mutex_cell {
+    point load() const {
+        std::shared_lock lock(smtx);
+        return value;
+    }
+
+    template <typename F>
+    void update(F &&f) {
+        std::unique_lock lock(smtx);
+        f(value);
+    }
+
+    mutable std::shared_mutex smtx;
+    point value;
+};
+
+// ratio为读写比，每ratio+1次操作中有一次写
+template <typename Cell>
+double run(Cell &cell, int threads, int ratio, std::chrono::milliseconds duration) {
+    std::atomic<bool> start = false, stop = false;
+    std::atomic<long long> ops = 0, torn = 0;
+    std::vector<std::jthread> ts;
+    for (int t = 0; t < threads; ++t) {
+        ts.emplace_back([&, t] {
+            start.wait(false);
+            long long n = 0, bad = 0;
+            std::uint32_t seed = t * 2654435761u + 1;
+            while (!stop.load(std::memory_order_relaxed)) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                if (seed % (ratio + 1) == 0) {
+                    cell.update([](point &p) {
+                        ++p.x;
+                        ++p.y;
+                        ++p.z;
+                        ++p.w;
+                    });
+                } else {
+                    auto p = cell.load();
+                    bad += !(p.x == p.y && p.y == p.z && p.z == p.w);
+                }
+                ++n;
+            }
+            ops += n;
+            torn += bad;
+        });
+    }
+
+    start = true;
+    start.notify_all();
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    ts.clear();
+
+    if (torn)
+        std::cout << "torn reads: " << torn << "\n";
+    return ops / (duration.count() * 1e3);
+}
+
+int main(void) {
+    // 1. 顺序锁：读者只读序号，写者之间互斥
+    {
+        seqlock<point> sl;
+        sl.update([](point &p) { p.x = p.y = p.z = p.w = 1; });
+        auto p = sl.load();
+        std::cout << "seqlock read value = " << p.x << "\n";
+    }
+
+    // 2. RCU快照：读者读旧快照时，写者可以同时发布新快照
+    {
+        rcu_cell<point> cell;
+        cell.read([&](const point &old) {
+            cell.store(point{2, 2, 2, 2});
+            // 旧快照在读区结束前不会被释放
+            std::cout << "rcu old value = " << old.x << ", new value = " << cell.load().x << "\n";
+        });
+    }
+
+    // 3. benchmark: 读写比 x 线程数，输出 Mops/s
+    {
+        const auto duration = 200ms;
+        const int ratios[] = {1, 10, 100, 1000};
+        const int thread_counts[] = {1, 2, 4, 8, 16};
+
+        std::cout << "ratio\tthreads\tshared_mutex\tseqlock\trcu\n";
+        for (int ratio : ratios) {
+            for (int threads : thread_counts) {
+                shared_mutex_cell a;
+                seqlock<point> b;
+                rcu_cell<point> c;
+                auto ra = run(a, threads, ratio, duration);
+                auto rb = run(b, threads, ratio, duration);
+                auto rc = run(c, threads, ratio, duration);
+                std::cout << ratio << ":1\t" << threads << "\t" << ra << "\t\t" << rb << "\t" << rc << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// RCU风格的快照单元(read-copy-update)
+// 1) 读者拿到当前快照的指针直接读，不加锁，不重试
+// 2) 写者拷贝一份新快照，修改后原子替换指针，旧快照延迟回收
+// 3) 回收用epoch判定：每个读者线程在进入读区时登记当前epoch，
+//    旧快照在替换时记下epoch，所有活跃读者登记的epoch都比它大时才能释放
+// 读者登记用的槽位在所有rcu_cell之间共享，每个线程一个，最多max_threads个
+
+class rcu_domain {
+  public:
+    static constexpr std::size_t max_threads = 256;
+    static constexpr std::uint64_t inactive = std::numeric_limits<std::uint64_t>::max();
+
+    static rcu_domain &instance() {
+        static rcu_domain d;
+        return d;
+    }
+
+    std::uint64_t epoch() const {
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    std::uint64_t advance() {
+        return epoch_.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    // 所有活跃读者中最小的epoch
+    std::uint64_t min_active() const {
+        auto n = used_.load(std::memory_order_acquire);
+        auto m = inactive;
+        for (std::size_t i = 0; i < n; ++i)
+            m = std::min(m, slots_[i].epoch.load(std::memory_order_seq_cst));
+        return m;
+    }
+
+    // 读区，同一线程可以嵌套
+    class read_guard {
+      public:
+        read_guard() : slot_(local()) {
+            if (slot_.depth++ == 0)
+                slot_.ref->store(instance().epoch(), std::memory_order_seq_cst);
+        }
+
+        ~read_guard() {
+            if (--slot_.depth == 0)
+                slot_.ref->store(inactive, std::memory_order_release);
+        }
+
+        read_guard(const read_guard &) = delete;
+        read_guard &operator=(const read_guard &) = delete;
+
+      private:
+        struct local_slot {
+            std::size_t index = 0;
+            std::atomic<std::uint64_t> *ref = nullptr;
+            int depth = 0;
+
+            local_slot() : index(instance().acquire_slot()), ref(&instance().slots_[index].epoch) {
+            }
+            ~local_slot() {
+                instance().release_slot(index);
+            }
+        };
+
+        static local_slot &local() {
+            static thread_local local_slot s;
+            return s;
+        }
+
+        local_slot &slot_;
+    };
+
+  private:
+    struct alignas(64) slot {
+        std::atomic<std::uint64_t> epoch{inactive};
+        std::atomic<bool> owned{false};
+    };
+
+    std::size_t acquire_slot() {
+        for (std::size_t i = 0; i < max_threads; ++i) {
+            bool expected = false;
+            if (slots_[i].owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                // used_只增不减，扫描范围是历史最大的线程数
+                auto n = used_.load(std::memory_order_relaxed);
+                while (n < i + 1 && !used_.compare_exchange_weak(n, i + 1, std::memory_order_acq_rel)) {
+                }
+                return i;
+            }
+        }
+        throw std::runtime_error("rcu_domain: too many reader threads");
+    }
+
+    void release_slot(std::size_t i) {
+        slots_[i].epoch.store(inactive, std::memory_order_release);
+        slots_[i].owned.store(false, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<std::uint64_t> epoch_{1};
+    std::atomic<std::size_t> used_{0};
+    slot slots_[max_threads];
+};
+
+template <typename T>
+class rcu_cell {
+  public:
+    rcu_cell() : rcu_cell(T{}) {
+    }
+
+    explicit rcu_cell(T v) : current_(new T(std::move(v))) {
+    }
+
+    rcu_cell(const rcu_cell &) = delete;
+    rcu_cell &operator=(const rcu_cell &) = delete;
+
+    // 析构时不能再有读者
+    ~rcu_cell() {
+        delete current_.load(std::memory_order_relaxed);
+        for (auto &r : retired_)
+            delete r.ptr;
+    }
+
+    // 在读区内访问快照，f接收const T&
+    template <typename F>
+    decltype(auto) read(F &&f) const {
+        rcu_domain::read_guard g;
+        return std::forward<F>(f)(*current_.load(std::memory_order_seq_cst));
+    }
+
+    T load() const {
+        return read([](const T &v) { return v; });
+    }
+
+    void store(T v) {
+        publish(new T(std::move(v)));
+    }
+
+    // 读改写：拷贝当前快照，f修改拷贝，再发布
+    template <typename F>
+    void update(F &&f) {
+        std::lock_guard lg(write_mtx_);
+        auto *next = new T(*current_.load(std::memory_order_relaxed));
+        std::forward<F>(f)(*next);
+        publish_locked(next);
+    }
+
+  private:
+    struct retired {
+        T *ptr;
+        std::uint64_t epoch;
+    };
+
+    void publish(T *next) {
+        std::lock_guard lg(write_mtx_);
+        publish_locked(next);
+    }
+
+    void publish_locked(T *next) {
+        auto &d = rcu_domain::instance();
+        auto *old = current_.exchange(next, std::memory_order_seq_cst);
+        // 在这之前进入读区的读者登记的epoch都不大于e
+        auto e = d.advance();
+        retired_.push_back({old, e});
+
+        auto min = d.min_active();
+        auto it = std::partition(retired_.begin(), retired_.end(), [min](const retired &r) { return r.epoch >= min; });
+        for (auto p = it; p != retired_.end(); ++p)
+            delete p->ptr;
+        retired_.erase(it, retired_.end());
+    }
+
+    alignas(64) std::atomic<T *> current_;
+    std::mutex write_mtx_;
+    std::vector<retired> retired_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// 顺序锁
+// 1) 读者完全不写共享内存，只读两次序号，不会和其他读者抢同一条缓存行
+// 2) 序号为奇数表示正在写，读者读到前后序号不一致就重试
+// 3) 只适合可平凡拷贝的小对象，读者可能读到写了一半的数据，靠序号判定后丢弃
+// 数据按字存成relaxed原子量，避免读写并发的数据竞争UB
+template <typename T>
+class seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock只支持可平凡拷贝的类型");
+
+    using word_t = std::uintptr_t;
+    static constexpr std::size_t words = (sizeof(T) + sizeof(word_t) - 1) / sizeof(word_t);
+
+  public:
+    seqlock() : seqlock(T{}) {
+    }
+
+    explicit seqlock(const T &v) {
+        write_words(v);
+    }
+
+    seqlock(const seqlock &) = delete;
+    seqlock &operator=(const seqlock &) = delete;
+
+    T load() const {
+        for (;;) {
+            auto s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            T v = read_words();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s1)
+                return v;
+        }
+    }
+
+    void store(const T &v) {
+        auto s = lock();
+        write_words(v);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // 读改写，f接收T&，整个过程持有写锁
+    template <typename F>
+    void update(F &&f) {
+        auto s = lock();
+        T v = read_words();
+        f(v);
+        write_words(v);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+  private:
+    // 写者之间互斥：把偶数序号CAS成奇数
+    std::uint64_t lock() {
+        for (;;) {
+            auto s = seq_.load(std::memory_order_relaxed);
+            if (!(s & 1) && seq_.compare_exchange_weak(s, s + 1, std::memory_order_relaxed)) {
+                std::atomic_thread_fence(std::memory_order_release);
+                return s;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    T read_words() const {
+        word_t buf[words];
+        for (std::size_t i = 0; i < words; ++i)
+            buf[i] = data_[i].load(std::memory_order_relaxed);
+        T v;
+        std::memcpy(&v, buf, sizeof(T));
+        return v;
+    }
+
+    void write_words(const T &v) {
+        word_t buf[words]{};
+        std::memcpy(buf, &v, sizeof(T));
+        for (std::size_t i = 0; i < words; ++i)
+            data_[i].store(buf[i], std::memory_order_relaxed);
+    }
+
+    alignas(64) std::atomic<std::uint64_t> seq_{0};
+    std::atomic<word_t> data_[words];
+};
@@ -0,0 +1,115 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "ordered_lock.hpp"
+
+// 和02mutex中的worker1/worker2一样，两个线程以相反的参数顺序锁两个mutex
+// 分级之后不管参数怎么写，实际加锁顺序都是m1 -> m2
+ranked_mutex<> m1(1), m2(2);
+int x = 0, y = 0;
+
+void worker1() {
+    ordered_lock lock(m1, m2);
+    x++;
+    y++;
+}
+
+void worker2() {
+    ordered_lock lock(m2, m1);
+    x++;
+    y++;
+}
+
+// 每个线程从不同的起点开始列出K个mutex，模拟各处代码参数顺序不一致
+template <std::size_t K, std::size_t... I>
+double bench_scoped(int threads, int iters, std::index_sequence<I...>) {
+    std::array<std::mutex, K> ms;
+    long long counter = 0;
+    return time_ms([&] {
+        std::vector<std::jthread> ts;
+        for (int t = 0; t < threads; ++t) {
+            ts.emplace_back([&, r = std::size_t(t)] {
+                for (int i = 0; i < iters; ++i) {
+                    std::scoped_lock lock(ms[(I + r) % K]...);
+                    ++counter;
+                }
+            });
+        }
+    });
+}
+
+template <std::size_t K, std::size_t... I>
+double bench_ordered(int threads, int iters, std::index_sequence<I...>) {
+    std::array<ranked_mutex<>, K> ms;
+    long long counter = 0;
+    return time_ms([&] {
+        std::vector<std::jthread> ts;
+        for (int t = 0; t < threads; ++t) {
+            ts.emplace_back([&, r = std::size_t(t)] {
+                for (int i = 0; i < iters; ++i) {
+                    ordered_lock lock(ms[(I + r) % K]...);
+                    ++counter;
+                }
+            });
+        }
+    });
+}
+
+template <std::size_t K>
+void bench(int threads, int iters) {
+    auto a = bench_scoped<K>(threads, iters, std::make_index_sequence<K>{});
+    auto b = bench_ordered<K>(threads, iters, std::make_index_sequence<K>{});
+    std::cout << K << "\t" << a << "\t\t" << b << "\n";
+}
+
+int main(void) {
+    // 1. 分级锁解决worker1/worker2的死锁
+    {
+        std::thread t1(worker1);
+        std::thread t2(worker2);
+
+        t1.join();
+        t2.join();
+
+        std::cout << x << ", " << y << "\n";
+    }
+
+    // 2. 检查模式下，逆序加锁会被立刻发现，而不是等到线上偶发死锁
+    {
+        std::lock_guard lg2(m2);
+        try {
+            std::lock_guard lg1(m1);
+        } catch (const lock_order_error &e) {
+            std::cout << e.what() << "\n";
+        }
+    }
+
+    // 3. 运行时才知道数量的情况
+    {
+        std::vector<ranked_mutex<>> ms(4);
+        ordered_lock_range<std::mutex> lock({&ms[3], &ms[0], &ms[2], &ms[1]});
+        std::cout << "locked " << ms.size() << " mutexes\n";
+    }
+
+    // 4. benchmark: 32个线程，每次锁K个mutex，单位ms
+    // 需要release构建(-DNDEBUG)才能看到无检查的开销
+    {
+        const int threads = 32;
+        const int iters = 20000;
+        std::cout << "check: " << LOCK_ORDER_CHECK << "\n";
+        std::cout << "mutexes\tscoped_lock\tordered_lock\n";
+        bench<2>(threads, iters);
+        bench<4>(threads, iters);
+        bench<8>(threads, iters);
+        bench<16>(threads, iters);
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 分级锁
+// scoped_lock(m1, m2)用的是"锁一个、try其他、失败全放开重来"的算法，竞争激烈时会反复退避
+// 这里给每个mutex分配全局的等级，所有线程都严格按等级从小到大加锁，天然不会死锁，也不用试探
+// 检查模式下，每个线程记录自己持有的锁，加锁顺序违反等级就抛出lock_order_error
+// 默认跟随NDEBUG：debug构建开启检查，release构建检查代码整个不参与编译，没有额外开销
+#ifndef LOCK_ORDER_CHECK
+#ifdef NDEBUG
+#define LOCK_ORDER_CHECK 0
+#else
+#define LOCK_ORDER_CHECK 1
+#endif
+#endif
+
+struct lock_order_error : std::logic_error {
+    using std::logic_error::logic_error;
+};
+
+template <typename Mutex = std::mutex>
+class ranked_mutex {
+  public:
+    // 不指定等级时按构造顺序自动分配
+    ranked_mutex() : rank_(next_rank_.fetch_add(1, std::memory_order_relaxed)) {
+    }
+
+    explicit ranked_mutex(std::uint32_t rank) : rank_(rank) {
+    }
+
+    ranked_mutex(const ranked_mutex &) = delete;
+    ranked_mutex &operator=(const ranked_mutex &) = delete;
+
+    std::uint32_t rank() const noexcept {
+        return rank_;
+    }
+
+    void lock() {
+        check_before_lock();
+        m_.lock();
+        on_locked();
+    }
+
+    bool try_lock() {
+        // try_lock不会阻塞，不会形成等待环，不检查顺序
+        if (!m_.try_lock())
+            return false;
+        on_locked();
+        return true;
+    }
+
+    void unlock() {
+        on_unlock();
+        m_.unlock();
+    }
+
+    // 等级相同时用地址决胜，保证所有线程的全序一致
+    friend bool operator<(const ranked_mutex &a, const ranked_mutex &b) noexcept {
+        return a.key() < b.key();
+    }
+
+  private:
+    std::pair<std::uint32_t, std::uintptr_t> key() const noexcept {
+        return {rank_, reinterpret_cast<std::uintptr_t>(this)};
+    }
+
+#if LOCK_ORDER_CHECK
+    using key_t = std::pair<std::uint32_t, std::uintptr_t>;
+
+    static std::vector<key_t> &held() {
+        static thread_local std::vector<key_t> h;
+        return h;
+    }
+
+    void check_before_lock() const {
+        auto &h = held();
+        if (!h.empty()) {
+            auto top = *std::max_element(h.begin(), h.end());
+            if (!(top < key()))
+                throw lock_order_error("lock order violation: locking rank " + std::to_string(rank_) +
+                                       " while holding rank " + std::to_string(top.first));
+        }
+    }
+
+    void on_locked() {
+        held().push_back(key());
+    }
+
+    void on_unlock() {
+        auto &h = held();
+        auto it = std::find(h.rbegin(), h.rend(), key());
+        if (it != h.rend())
+            h.erase(std::next(it).base());
+    }
+#else
+    void check_before_lock() const noexcept {
+    }
+    void on_locked() noexcept {
+    }
+    void on_unlock() noexcept {
+    }
+#endif
+
+    static inline std::atomic<std::uint32_t> next_rank_{0};
+
+    Mutex m_;
+    std::uint32_t rank_;
+};
+
+// 排序后依次加锁，中途抛出lock_order_error时把已经锁上的放开
+template <typename It>
+void lock_in_rank_order(It first, It last) {
+    std::sort(first, last, [](auto *a, auto *b) { return *a < *b; });
+    for (auto it = first; it != last; ++it) {
+        try {
+            (*it)->lock();
+        } catch (...) {
+            while (it != first)
+                (*--it)->unlock();
+            throw;
+        }
+    }
+}
+
+// 按等级顺序一次锁住多个ranked_mutex，RAII释放
+// 和scoped_lock的用法一致：ordered_lock lock(m1, m2);
+template <typename Mutex, std::size_t N>
+class ordered_lock {
+  public:
+    template <typename... Ms>
+    explicit ordered_lock(Ms &...ms) : ms_{&ms...} {
+        lock_in_rank_order(ms_.begin(), ms_.end());
+    }
+
+    ~ordered_lock() {
+        for (auto it = ms_.rbegin(); it != ms_.rend(); ++it)
+            (*it)->unlock();
+    }
+
+    ordered_lock(const ordered_lock &) = delete;
+    ordered_lock &operator=(const ordered_lock &) = delete;
+
+  private:
+    std::array<ranked_mutex<Mutex> *, N> ms_;
+};
+
+template <typename Mutex, typename... Ms>
+ordered_lock(ranked_mutex<Mutex> &, Ms &...) -> ordered_lock<Mutex, 1 + sizeof...(Ms)>;
+
+// 数量运行时才确定时使用
+template <typename Mutex>
+class ordered_lock_range {
+  public:
+    explicit ordered_lock_range(std::vector<ranked_mutex<Mutex> *> ms) : ms_(std::move(ms)) {
+        lock_in_rank_order(ms_.begin(), ms_.end());
+    }
+
+    ~ordered_lock_range() {
+        for (auto it = ms_.rbegin(); it != ms_.rend(); ++it)
+            (*it)->unlock();
+    }
+
+    ordered_lock_range(const ordered_lock_range &) = delete;
+    ordered_lock_range &operator=(const ordered_lock_range &) = delete;
+
+  private:
+    std::vector<ranked_mutex<Mutex> *> ms_;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "../../common/cpu_relax.hpp"
+
+// 先自旋后休眠的自适应互斥量
+// 1) 临界区只有几十纳秒时，等一会儿锁就放开了，直接进内核休眠得不偿失
+// 2) 自旋用pause + 指数退避，降低对锁所在缓存行的争抢
+// 3) 自旋失败后用atomic::wait休眠(linux下是futex)，和03sync_primitive的waiter()一样
+// 4) 自旋上限按历史情况自适应：经常自旋就拿到锁就多转一会儿，经常转完还拿不到就少转
+// 满足Lockable要求，可以直接交给lock_guard/unique_lock/scoped_lock
+class adaptive_mutex {
+    // 0: 未锁，1: 已锁无等待者，2: 已锁且可能有等待者
+    enum : std::uint32_t { unlocked = 0, locked = 1, contended = 2 };
+
+  public:
+    static constexpr std::int32_t max_spin = 1024;
+
+    adaptive_mutex() = default;
+    adaptive_mutex(const adaptive_mutex &) = delete;
+    adaptive_mutex &operator=(const adaptive_mutex &) = delete;
+
+    void lock() noexcept {
+        if (try_lock())
+            return;
+        lock_slow();
+    }
+
+    bool try_lock() noexcept {
+        std::uint32_t expected = unlocked;
+        return state_.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept {
+        // 只有可能存在等待者时才需要系统调用
+        if (state_.exchange(unlocked, std::memory_order_release) == contended)
+            state_.notify_one();
+    }
+
+  private:
+    void lock_slow() noexcept {
+        auto limit = spin_limit_.load(std::memory_order_relaxed);
+        std::int32_t spins = 0;
+        for (std::int32_t backoff = 1; spins < limit; backoff = std::min(backoff * 2, 64)) {
+            for (std::int32_t i = 0; i < backoff; ++i)
+                cpu_relax();
+            spins += backoff;
+            // 先读后CAS，锁被占用时不去抢缓存行的独占权
+            if (state_.load(std::memory_order_relaxed) == unlocked && try_lock()) {
+                adapt(spins * 2);
+                return;
+            }
+        }
+        adapt(spins / 2);
+
+        // 休眠阶段：把状态置为contended，放锁的一方就知道要notify
+        // 醒来后用exchange重新抢，抢到时状态仍然是contended，保守地让下一次unlock去唤醒
+        while (state_.exchange(contended, std::memory_order_acquire) != unlocked)
+            state_.wait(contended, std::memory_order_relaxed);
+    }
+
+    // 指数平滑，和glibc的PTHREAD_MUTEX_ADAPTIVE_NP类似
+    void adapt(std::int32_t target) noexcept {
+        auto cur = spin_limit_.load(std::memory_order_relaxed);
+        auto next = std::clamp(cur + (target - cur) / 8, std::int32_t{16}, max_spin);
+        spin_limit_.store(next, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint32_t> state_{unlocked};
+    std::atomic<std::int32_t> spin_limit_{128};
+};
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "adaptive_mutex.hpp"
+
+// 替换02mutex中的全局mtx、m1、m2
+adaptive_mutex mtx;
+adaptive_mutex m1, m2;
+int x = 0, y = 0;
+
+void worker() {
+    std::scoped_lock lock(m1, m2);
+    x++;
+    y++;
+}
+
+// 临界区几十纳秒，临界区外做outside次pause，outside越小竞争越激烈
+template <typename Mutex>
+double bench(int threads, int iters, int outside) {
+    Mutex m;
+    long long counters[4]{};
+    auto ms = time_ms([&] {
+        std::vector<std::jthread> ts;
+        for (int t = 0; t < threads; ++t) {
+            ts.emplace_back([&] {
+                for (int i = 0; i < iters; ++i) {
+                    {
+                        std::lock_guard lg(m);
+                        for (auto &c : counters)
+                            ++c;
+                    }
+                    for (int k = 0; k < outside; ++k)
+                        cpu_relax();
+                }
+            });
+        }
+    });
+    // 返回 Mops/s
+    return threads * double(iters) / ms / 1e3;
+}
+
+int main(void) {
+    // 1. 满足Lockable要求，标准库的RAII锁都能直接使用
+    {
+        std::lock_guard lg(mtx);
+    }
+    {
+        std::unique_lock ul(mtx, std::defer_lock);
+        ul.lock();
+        ul.unlock();
+        if (ul.try_lock())
+            std::cout << "try_lock ok\n";
+    }
+    {
+        std::thread t1(worker);
+        std::thread t2(worker);
+        t1.join();
+        t2.join();
+        std::cout << x << ", " << y << "\n";
+    }
+
+    // 2. benchmark: 不同线程数和竞争程度下的吞吐，单位Mops/s
+    {
+        const int iters = 100000;
+        std::cout << "threads\toutside\tstd::mutex\tadaptive_mutex\n";
+        for (int outside : {0, 10, 100}) {
+            for (int threads : {1, 2, 4, 8, 16}) {
+                auto a = bench<std::mutex>(threads, iters, outside);
+                auto b = bench<adaptive_mutex>(threads, iters, outside);
+                std::cout << threads << "\t" << outside << "\t" << a << "\t\t" << b << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
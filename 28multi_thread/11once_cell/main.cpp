@@ -0,0 +1,102 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "once_cell.hpp"
+
+// 1. 替换02mutex中的call_once
+// 和16const_expression中的constinit int config_value一样，全局对象在编译期完成初始化
+constinit once_cell<int> resource;
+
+void init_resource() {
+    auto &r = resource.get_or_init([] {
+        std::cout << "init resource\n";
+        return 100;
+    });
+    std::cout << "use resource = " << r << "\n";
+}
+
+// 2. lazy把初始化函数一起存下来
+constinit lazy<std::string> greeting{[] { return std::string("hello once_cell"); }};
+
+// 3. 初始化失败重试
+int attempts = 0;
+once_cell<int> flaky;
+
+int flaky_init() {
+    if (++attempts < 3)
+        throw std::runtime_error("init failed, attempt " + std::to_string(attempts));
+    return attempts;
+}
+
+std::once_flag flag;
+int call_once_value = 0;
+constinit once_cell<int> cell;
+
+// 已经初始化完成之后的访问开销，iters次访问平均分给threads个线程
+template <typename F>
+double bench(int threads, long long iters, F &&get) {
+    std::atomic<long long> sink = 0;
+    const long long n = iters / threads;
+    auto ms = time_ms([&] {
+        std::vector<std::jthread> ts;
+        for (int t = 0; t < threads; ++t) {
+            ts.emplace_back([&, n] {
+                long long s = 0;
+                for (long long i = 0; i < n; ++i)
+                    s += get();
+                sink += s;
+            });
+        }
+    });
+    // 平均每次访问的纳秒数
+    return ms * 1e6 / iters;
+}
+
+int main(void) {
+    {
+        std::thread t1(init_resource);
+        std::thread t2(init_resource);
+        std::thread t3(init_resource);
+
+        t1.join();
+        t2.join();
+        t3.join();
+    }
+
+    std::cout << *greeting << ", size = " << greeting->size() << "\n";
+
+    for (int i = 0; i < 3; ++i) {
+        try {
+            auto v = flaky.get_or_init(flaky_init);
+            std::cout << "flaky = " << v << "\n";
+        } catch (const std::exception &e) {
+            std::cout << e.what() << "\n";
+        }
+    }
+
+    // 4. benchmark: 初始化完成后的访问，call_once vs once_cell，单位ns/次
+    {
+        const long long iters = 100'000'000;
+        auto by_call_once = [] {
+            std::call_once(flag, [] { call_once_value = 1; });
+            return call_once_value;
+        };
+        auto by_once_cell = [] { return cell.get_or_init([] { return 1; }); };
+
+        std::cout << "threads\tcall_once\tonce_cell\n";
+        for (int threads : {1, 4, 16}) {
+            auto a = bench(threads, iters, by_call_once);
+            auto b = bench(threads, iters, by_once_cell);
+            std::cout << threads << "\t" << a << "\t\t" << b << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// 只初始化一次的单元格
+// call_once每次调用都要走一遍once_flag的同步逻辑，once_cell初始化完成后只剩一次acquire读
+// 1) 构造函数是constexpr的，可以用constinit声明为全局变量，不存在静态初始化顺序问题
+// 2) 初始化函数抛异常时回到未初始化状态，下一个调用者重试，和call_once的语义一致
+// 3) 初始化期间其他线程在atomic上wait，不自旋
+template <typename T>
+class once_cell {
+    enum : std::uint8_t { empty = 0, running = 1, ready = 2 };
+
+  public:
+    constexpr once_cell() noexcept : dummy_{} {
+    }
+
+    once_cell(const once_cell &) = delete;
+    once_cell &operator=(const once_cell &) = delete;
+
+    ~once_cell() {
+        if (state_.load(std::memory_order_relaxed) == ready)
+            std::destroy_at(std::addressof(value_));
+    }
+
+    // 快路径只有一次acquire读，慢路径单独拆出去，便于内联
+    template <typename F>
+    T &get_or_init(F &&f) {
+        if (state_.load(std::memory_order_acquire) == ready) [[likely]]
+            return value_;
+        return init_slow(std::forward<F>(f));
+    }
+
+    // 未初始化时返回nullptr
+    T *get() noexcept {
+        return state_.load(std::memory_order_acquire) == ready ? std::addressof(value_) : nullptr;
+    }
+
+    bool has_value() const noexcept {
+        return state_.load(std::memory_order_acquire) == ready;
+    }
+
+  private:
+    template <typename F>
+    T &init_slow(F &&f) {
+        for (;;) {
+            auto s = state_.load(std::memory_order_acquire);
+            if (s == ready)
+                return value_;
+            if (s == empty &&
+                state_.compare_exchange_strong(s, running, std::memory_order_acquire, std::memory_order_acquire)) {
+                try {
+                    std::construct_at(std::addressof(value_), std::forward<F>(f)());
+                } catch (...) {
+                    // 放弃这次初始化，唤醒等待者让它们重试
+                    state_.store(empty, std::memory_order_release);
+                    state_.notify_all();
+                    throw;
+                }
+                state_.store(ready, std::memory_order_release);
+                state_.notify_all();
+                return value_;
+            }
+            state_.wait(running, std::memory_order_acquire);
+        }
+    }
+
+    std::atomic<std::uint8_t> state_{empty};
+    union {
+        char dummy_;
+        T value_;
+    };
+};
+
+// 惰性值：把初始化函数和once_cell绑在一起，第一次访问时初始化
+// 初始化函数默认是函数指针，无捕获lambda也能转换，保证constexpr构造
+template <typename T, typename F = T (*)()>
+class lazy {
+  public:
+    constexpr explicit lazy(F f) noexcept : init_(f) {
+    }
+
+    T &get() {
+        return cell_.get_or_init(init_);
+    }
+
+    T &operator*() {
+        return get();
+    }
+
+    T *operator->() {
+        return std::addressof(get());
+    }
+
+  private:
+    once_cell<T> cell_;
+    F init_;
+};
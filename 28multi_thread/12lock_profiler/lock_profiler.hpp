@@ -0,0 +1,458 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <source_location>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 锁竞争分析器
+// profiled<M>包装02mutex中用到的四种互斥量，按加锁的代码位置统计：
+// 1) 加锁次数、发生竞争(try_lock失败)的次数
+// 2) 等待时间直方图：只在竞争时计时，无竞争路径不读时钟
+// 3) 持有时间直方图：每sample_period次加锁采样一次，竞争时必定采样
+// 统计数据写在线程私有的表里，线程退出时合并到全局，程序退出时打印报告
+// LOCK_PROFILER为0时profiled<M>就是M本身，没有任何开销
+#ifndef LOCK_PROFILER
+#define LOCK_PROFILER 1
+#endif
+
+#if LOCK_PROFILER
+
+namespace lock_profiler {
+
+// 时间戳：x86上用rdtsc，报告时再换算成纳秒，比steady_clock::now()便宜一个数量级
+inline std::uint64_t tick() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// 对数直方图，第i个桶统计[2^(i-1), 2^i)个tick
+struct histogram {
+    static constexpr std::size_t buckets = 40;
+    std::array<std::uint64_t, buckets> count{};
+
+    void add(std::uint64_t ticks) noexcept {
+        ++count[std::min<std::size_t>(std::bit_width(ticks), buckets - 1)];
+    }
+
+    void merge(const histogram &o) noexcept {
+        for (std::size_t i = 0; i < buckets; ++i)
+            count[i] += o.count[i];
+    }
+
+    std::uint64_t total() const noexcept {
+        std::uint64_t n = 0;
+        for (auto c : count)
+            n += c;
+        return n;
+    }
+
+    // 返回分位点所在桶的上界(tick)
+    std::uint64_t percentile(double p) const noexcept {
+        auto n = total();
+        if (n == 0)
+            return 0;
+        auto target = static_cast<std::uint64_t>(p * (n - 1)) + 1;
+        std::uint64_t acc = 0;
+        for (std::size_t i = 0; i < buckets; ++i) {
+            acc += count[i];
+            if (acc >= target)
+                return i == 0 ? 0 : (std::uint64_t{1} << i);
+        }
+        return std::uint64_t{1} << (buckets - 1);
+    }
+};
+
+struct site_key {
+    const char *file = nullptr;
+    const char *function = nullptr;
+    std::uint32_t line = 0;
+    const char *kind = nullptr;
+
+    bool operator==(const site_key &) const = default;
+};
+
+struct site_stats {
+    site_key key;
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    histogram wait;
+    histogram hold;
+
+    void merge(const site_stats &o) noexcept {
+        acquisitions += o.acquisitions;
+        contended += o.contended;
+        wait.merge(o.wait);
+        hold.merge(o.hold);
+    }
+};
+
+inline std::atomic<std::uint32_t> sample_period{64};
+
+// 设置持有时间的采样周期，1为每次都采样
+inline void set_sample_period(std::uint32_t n) noexcept {
+    sample_period.store(std::max<std::uint32_t>(n, 1), std::memory_order_relaxed);
+}
+
+class registry {
+  public:
+    static registry &instance() {
+        static registry r;
+        return r;
+    }
+
+    void merge(const site_stats &s) {
+        std::lock_guard lg(mtx_);
+        auto k = std::make_tuple(std::string(s.key.file), s.key.line, std::string(s.key.kind));
+        auto [it, inserted] = sites_.try_emplace(k, s);
+        if (!inserted)
+            it->second.merge(s);
+    }
+
+    void add_dropped(std::uint64_t n) {
+        dropped_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 打印报告，时间换算成纳秒
+    void report(std::ostream &os) {
+        std::lock_guard lg(mtx_);
+        auto ns_per_tick = calibrate();
+        auto ns = [ns_per_tick](std::uint64_t t) { return static_cast<std::uint64_t>(t * ns_per_tick); };
+
+        std::vector<const site_stats *> v;
+        for (auto &[k, s] : sites_)
+            v.push_back(&s);
+        // 按竞争次数排序，最值得关注的排在前面
+        std::sort(v.begin(), v.end(), [](auto *a, auto *b) { return a->contended > b->contended; });
+
+        os << "==== lock profile ====\n";
+        os << std::left << std::setw(40) << "site" << std::setw(16) << "kind" << std::right << std::setw(10) << "acquire"
+           << std::setw(10) << "contend" << std::setw(12) << "wait p50" << std::setw(12) << "wait p99" << std::setw(12)
+           << "hold p50" << std::setw(12) << "hold p99" << "\n";
+        for (auto *s : v) {
+            std::string file = s->key.file;
+            auto slash = file.find_last_of('/');
+            if (slash != std::string::npos)
+                file = file.substr(slash + 1);
+            os << std::left << std::setw(40) << (file + ":" + std::to_string(s->key.line)) << std::setw(16)
+               << s->key.kind << std::right << std::setw(10) << s->acquisitions << std::setw(10) << s->contended
+               << std::setw(10) << ns(s->wait.percentile(0.5)) << "ns" << std::setw(10)
+               << ns(s->wait.percentile(0.99)) << "ns" << std::setw(10) << ns(s->hold.percentile(0.5)) << "ns"
+               << std::setw(10) << ns(s->hold.percentile(0.99)) << "ns\n";
+        }
+        if (auto d = dropped_.load(std::memory_order_relaxed))
+            os << "dropped acquisitions (site table full): " << d << "\n";
+    }
+
+    // 程序退出时自动输出
+    ~registry() {
+        if (!sites_.empty())
+            report(std::cout);
+    }
+
+  private:
+    registry() : tick0_(tick()), time0_(std::chrono::steady_clock::now()) {
+    }
+
+    double calibrate() const {
+#if defined(__x86_64__) || defined(__i386__)
+        auto dt = std::chrono::steady_clock::now() - time0_;
+        auto dticks = tick() - tick0_;
+        auto dns = std::chrono::duration<double, std::nano>(dt).count();
+        return dticks ? dns / dticks : 1.0;
+#else
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::duration(1)).count();
+#endif
+    }
+
+    std::mutex mtx_;
+    std::map<std::tuple<std::string, std::uint32_t, std::string>, site_stats> sites_;
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t tick0_;
+    std::chrono::steady_clock::time_point time0_;
+};
+
+// 线程私有的统计表，开放寻址，加锁路径上不需要任何同步
+class thread_buffer {
+    static constexpr std::size_t table_size = 64;
+    static constexpr std::size_t max_held = 32;
+
+    struct held {
+        const void *mutex;
+        site_stats *site;
+        std::uint64_t start;
+    };
+
+  public:
+    static thread_buffer &local() {
+        static thread_local thread_buffer b;
+        return b;
+    }
+
+    // 表放在堆上，不占用每个线程的静态TLS
+    thread_buffer() : table_(table_size) {
+        // 保证registry先于任何线程缓冲构造，析构时才能安全合并
+        registry::instance();
+    }
+
+    ~thread_buffer() {
+        auto &r = registry::instance();
+        for (auto &s : table_)
+            if (s.key.file)
+                r.merge(s);
+        if (dropped_)
+            r.add_dropped(dropped_);
+    }
+
+    site_stats *site(const std::source_location &loc, const char *kind) noexcept {
+        site_key k{loc.file_name(), loc.function_name(), loc.line(), kind};
+        auto h = (reinterpret_cast<std::uintptr_t>(k.file) >> 3) ^ (k.line * 2654435761u) ^
+                 (reinterpret_cast<std::uintptr_t>(kind) >> 3);
+        for (std::size_t i = 0; i < table_size; ++i) {
+            auto &s = table_[(h + i) & (table_size - 1)];
+            if (s.key == k)
+                return &s;
+            if (!s.key.file) {
+                s.key = k;
+                return &s;
+            }
+        }
+        ++dropped_;
+        return nullptr;
+    }
+
+    // 加锁成功后调用，决定是否对这次持有计时
+    void acquired(const void *m, site_stats *s, bool contended, std::uint64_t now = 0) noexcept {
+        if (!s)
+            return;
+        ++s->acquisitions;
+        if (!contended && --countdown_ != 0)
+            return;
+        countdown_ = sample_period.load(std::memory_order_relaxed);
+        if (n_held_ < max_held)
+            held_[n_held_++] = {m, s, now ? now : tick()};
+    }
+
+    void released(const void *m) noexcept {
+        if (n_held_ == 0) [[likely]]
+            return;
+        for (auto i = n_held_; i-- > 0;) {
+            if (held_[i].mutex == m) {
+                held_[i].site->hold.add(tick() - held_[i].start);
+                held_[i] = held_[--n_held_];
+                return;
+            }
+        }
+    }
+
+  private:
+    std::vector<site_stats> table_;
+    std::array<held, max_held> held_{};
+    std::size_t n_held_ = 0;
+    std::uint32_t countdown_ = 1;
+    std::uint64_t dropped_ = 0;
+};
+
+template <typename M>
+constexpr const char *kind_name = "mutex";
+template <>
+inline constexpr const char *kind_name<std::recursive_mutex> = "recursive_mutex";
+template <>
+inline constexpr const char *kind_name<std::timed_mutex> = "timed_mutex";
+template <>
+inline constexpr const char *kind_name<std::shared_mutex> = "shared_mutex";
+
+inline constexpr const char *shared_kind = "shared_mutex(r)";
+
+} // namespace lock_profiler
+
+// 互斥量包装，接口和被包装的类型一致，多了一个默认的source_location参数记录加锁位置
+// 注意：通过std::lock_guard等标准RAII加锁时，记录的位置是标准库头文件内部
+// 想要按调用点统计请使用下面的profiled_lock_guard/profiled_shared_lock
+template <typename M>
+class profiled {
+  public:
+    profiled() = default;
+    profiled(const profiled &) = delete;
+    profiled &operator=(const profiled &) = delete;
+
+    void lock(std::source_location loc = std::source_location::current()) {
+        auto &tb = lock_profiler::thread_buffer::local();
+        auto *s = tb.site(loc, lock_profiler::kind_name<M>);
+        if (m_.try_lock()) {
+            tb.acquired(this, s, false);
+            return;
+        }
+        auto t0 = lock_profiler::tick();
+        m_.lock();
+        auto t1 = lock_profiler::tick();
+        if (s) {
+            ++s->contended;
+            s->wait.add(t1 - t0);
+        }
+        tb.acquired(this, s, true, t1);
+    }
+
+    bool try_lock(std::source_location loc = std::source_location::current()) {
+        if (!m_.try_lock())
+            return false;
+        auto &tb = lock_profiler::thread_buffer::local();
+        tb.acquired(this, tb.site(loc, lock_profiler::kind_name<M>), false);
+        return true;
+    }
+
+    void unlock() {
+        lock_profiler::thread_buffer::local().released(this);
+        m_.unlock();
+    }
+
+    // timed_mutex
+    template <typename Rep, typename Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period> &d,
+                      std::source_location loc = std::source_location::current())
+        requires requires(M &m) { m.try_lock_for(d); }
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + d, loc);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_lock_until(const std::chrono::time_point<Clock, Duration> &tp,
+                        std::source_location loc = std::source_location::current())
+        requires requires(M &m) { m.try_lock_until(tp); }
+    {
+        auto &tb = lock_profiler::thread_buffer::local();
+        auto *s = tb.site(loc, lock_profiler::kind_name<M>);
+        if (m_.try_lock()) {
+            tb.acquired(this, s, false);
+            return true;
+        }
+        auto t0 = lock_profiler::tick();
+        bool ok = m_.try_lock_until(tp);
+        auto t1 = lock_profiler::tick();
+        if (s) {
+            ++s->contended;
+            s->wait.add(t1 - t0);
+        }
+        if (ok)
+            tb.acquired(this, s, true, t1);
+        return ok;
+    }
+
+    // shared_mutex
+    void lock_shared(std::source_location loc = std::source_location::current())
+        requires requires(M &m) { m.lock_shared(); }
+    {
+        auto &tb = lock_profiler::thread_buffer::local();
+        auto *s = tb.site(loc, lock_profiler::shared_kind);
+        if (m_.try_lock_shared()) {
+            tb.acquired(this, s, false);
+            return;
+        }
+        auto t0 = lock_profiler::tick();
+        m_.lock_shared();
+        auto t1 = lock_profiler::tick();
+        if (s) {
+            ++s->contended;
+            s->wait.add(t1 - t0);
+        }
+        tb.acquired(this, s, true, t1);
+    }
+
+    bool try_lock_shared(std::source_location loc = std::source_location::current())
+        requires requires(M &m) { m.try_lock_shared(); }
+    {
+        if (!m_.try_lock_shared())
+            return false;
+        auto &tb = lock_profiler::thread_buffer::local();
+        tb.acquired(this, tb.site(loc, lock_profiler::shared_kind), false);
+        return true;
+    }
+
+    void unlock_shared()
+        requires requires(M &m) { m.unlock_shared(); }
+    {
+        lock_profiler::thread_buffer::local().released(this);
+        m_.unlock_shared();
+    }
+
+  private:
+    M m_;
+};
+
+// 记录调用点的RAII锁
+template <typename M>
+class profiled_lock_guard {
+  public:
+    explicit profiled_lock_guard(M &m, std::source_location loc = std::source_location::current()) : m_(m) {
+        m_.lock(loc);
+    }
+    ~profiled_lock_guard() {
+        m_.unlock();
+    }
+    profiled_lock_guard(const profiled_lock_guard &) = delete;
+    profiled_lock_guard &operator=(const profiled_lock_guard &) = delete;
+
+  private:
+    M &m_;
+};
+
+template <typename M>
+class profiled_shared_lock {
+  public:
+    explicit profiled_shared_lock(M &m, std::source_location loc = std::source_location::current()) : m_(m) {
+        m_.lock_shared(loc);
+    }
+    ~profiled_shared_lock() {
+        m_.unlock_shared();
+    }
+    profiled_shared_lock(const profiled_shared_lock &) = delete;
+    profiled_shared_lock &operator=(const profiled_shared_lock &) = delete;
+
+  private:
+    M &m_;
+};
+
+namespace lock_profiler {
+// 手动输出报告，只包含已经退出的线程，退出时仍会再输出一次完整报告
+inline void report(std::ostream &os = std::cout) {
+    registry::instance().report(os);
+}
+} // namespace lock_profiler
+
+#else
+
+template <typename M>
+using profiled = M;
+template <typename M>
+using profiled_lock_guard = std::lock_guard<M>;
+template <typename M>
+using profiled_shared_lock = std::shared_lock<M>;
+
+namespace lock_profiler {
+inline void set_sample_period(std::uint32_t) noexcept {
+}
+inline void report(std::ostream & = std::cout) {
+}
+} // namespace lock_profiler
+
+#endif
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "lock_profiler.hpp"
+using namespace std::chrono_literals;
+
+// 02mutex中的四种互斥量，换成带统计的版本
+profiled<std::recursive_mutex> rmtx;
+profiled<std::mutex> mtx;
+profiled<std::timed_mutex> tmtx;
+profiled<std::shared_mutex> smtx;
+
+void rfunc(int n) {
+    profiled_lock_guard lg(rmtx);
+    if (n > 0)
+        rfunc(n - 1);
+}
+
+int value = 0;
+void reader() {
+    profiled_shared_lock lock(smtx);
+    std::this_thread::sleep_for(1ms);
+    (void)value;
+}
+
+void writer() {
+    profiled_lock_guard lock(smtx);
+    std::this_thread::sleep_for(1ms);
+    value++;
+}
+
+void hot() {
+    for (int i = 0; i < 10000; ++i) {
+        profiled_lock_guard lg(mtx);
+        value++;
+    }
+}
+
+int main(void) {
+    // 1. 和02mutex相同的用法，加锁位置会出现在退出时的报告中
+    rfunc(3);
+
+    {
+        if (tmtx.try_lock_for(1s))
+            tmtx.unlock();
+        // 标准库的RAII锁也能用，但记录的位置是标准库内部
+        std::unique_lock ul(mtx);
+    }
+
+    {
+        std::vector<std::jthread> ts;
+        for (int i = 0; i < 4; ++i) {
+            ts.emplace_back(reader);
+            ts.emplace_back(writer);
+            ts.emplace_back(hot);
+        }
+    }
+
+    // 2. 无竞争时的额外开销，单位ns/次
+    {
+        const int iters = 10'000'000;
+        std::mutex plain;
+        profiled<std::mutex> prof;
+
+        auto a = time_ms([&] {
+            for (int i = 0; i < iters; ++i) {
+                std::lock_guard lg(plain);
+            }
+        });
+        auto b = time_ms([&] {
+            for (int i = 0; i < iters; ++i) {
+                profiled_lock_guard lg(prof);
+            }
+        });
+        lock_profiler::set_sample_period(1);
+        auto c = time_ms([&] {
+            for (int i = 0; i < iters; ++i) {
+                profiled_lock_guard lg(prof);
+            }
+        });
+        lock_profiler::set_sample_period(64);
+
+        std::cout << "std::mutex:            " << a * 1e6 / iters << " ns\n";
+        std::cout << "profiled (sample 64):  " << b * 1e6 / iters << " ns\n";
+        std::cout << "profiled (sample 1):   " << c * 1e6 / iters << " ns\n";
+    }
+
+    // 3. 程序退出时自动打印报告
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.hpp"
+using namespace std::chrono_literals;
+
+// 对照组：mutex + condition_variable的有界队列，03sync_primitive中wait_thread/signal_thread的写法
+template <typename T>
+class locked_queue {
+  public:
+    explicit locked_queue(std::size_t capacity) : capacity_(capacity) {
+    }
+
+    void push(T v) {
+        std::unique_lock lock(m_);
+        not_full_.wait(lock, [&] { return q_.size() < capacity_; });
+        q_.push_back(std::move(v));
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock lock(m_);
+        not_empty_.wait(lock, [&] { return !q_.empty(); });
+        T v = std::move(q_.front());
+        q_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return v;
+    }
+
+  private:
+    std::size_t capacity_;
+    std::mutex m_;
+    std::condition_variable not_empty_, not_full_;
+    std::deque<T> q_;
+};
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct result {
+    double mops;
+    std::int64_t p50, p99;
+};
+
+// 每个元素带上入队时间戳，消费者统计入队到出队的延迟
+// 每个消费者采样一部分延迟，最后合并排序求分位点
+template <typename Queue>
+result bench(int producers, int consumers, int items) {
+    Queue q(1024);
+    const int per_producer = items / producers;
+    const int total = per_producer * producers;
+    std::vector<std::vector<std::int64_t>> lat(consumers);
+
+    auto beg = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> ts;
+        for (int p = 0; p < producers; ++p) {
+            ts.emplace_back([&] {
+                for (int i = 0; i < per_producer; ++i)
+                    q.push(now_ns());
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            // 最后一个消费者把除不尽的部分也吃掉
+            int n = total / consumers + (c == consumers - 1 ? total % consumers : 0);
+            ts.emplace_back([&, c, n] {
+                lat[c].reserve(n / 16 + 1);
+                for (int i = 0; i < n; ++i) {
+                    auto ts = q.pop();
+                    if (i % 16 == 0)
+                        lat[c].push_back(now_ns() - ts);
+                }
+            });
+        }
+    }
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beg).count();
+
+    std::vector<std::int64_t> all;
+    for (auto &v : lat)
+        all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    return {total / ms / 1e3, all[all.size() / 2], all[all.size() * 99 / 100]};
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 代替条件变量的单值交接
+    {
+        mpmc_queue<std::string> q(2);
+        std::thread t1([&] { std::cout << q.pop() << "\n"; });
+        std::thread t2([&] {
+            std::this_thread::sleep_for(100ms);
+            q.push("Ready!");
+        });
+        t1.join();
+        t2.join();
+    }
+
+    // 2. 非阻塞接口
+    {
+        mpmc_queue<int> q(2);
+        std::cout << q.try_push(1) << q.try_push(2) << q.try_push(3) << "\n"; // 110
+        std::cout << *q.try_pop() << *q.try_pop() << q.try_pop().has_value() << "\n"; // 120
+    }
+
+    // 3. benchmark: 吞吐(Mops/s)和入队到出队的延迟(ns)
+    {
+        const int items = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+        std::cout << "P:C\tmutex+cv Mops\tp50\tp99\tmpmc Mops\tp50\tp99\n";
+        for (int n : {1, 4, 16}) {
+            auto a = bench<locked_queue<std::int64_t>>(n, n, items);
+            auto b = bench<mpmc_queue<std::int64_t>>(n, n, items);
+            std::cout << n << ":" << n << "\t" << a.mops << "\t\t" << a.p50 << "\t" << a.p99 << "\t" << b.mops
+                      << "\t\t" << b.p50 << "\t" << b.p99 << "\n";
+        }
+    }
+
+    return 0;
+}
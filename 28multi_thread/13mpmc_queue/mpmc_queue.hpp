@@ -0,0 +1,156 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// 有界多生产者多消费者队列(Vyukov)
+// 每个槽位有一个序号seq：
+// 1) seq == pos              槽位空，等待第pos个生产者
+// 2) seq == pos + 1          槽位满，等待第pos个消费者
+// 3) 消费完把seq设为pos + capacity，交给下一圈的生产者
+// try_push/try_pop用CAS抢位置，失败立即返回
+// push/pop用fetch_add直接领号，然后在自己槽位的seq上atomic::wait，没有mutex
+// 和03sync_primitive的waiter()/notifier()一样，只有值不满足时才休眠
+template <typename T>
+class mpmc_queue {
+    struct alignas(64) slot {
+        std::atomic<std::size_t> seq;
+        alignas(T) std::byte storage[sizeof(T)];
+
+        T *ptr() noexcept {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+  public:
+    // 容量必须是2的幂，用位运算代替取模
+    explicit mpmc_queue(std::size_t capacity) : mask_(capacity - 1), slots_(new slot[capacity]) {
+        if (capacity < 2 || (capacity & mask_) != 0)
+            throw std::invalid_argument("mpmc_queue: capacity must be a power of 2");
+        for (std::size_t i = 0; i < capacity; ++i)
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue &) = delete;
+    mpmc_queue &operator=(const mpmc_queue &) = delete;
+
+    ~mpmc_queue() {
+        // 析构时没有并发访问，把还在队列里的元素析构掉
+        for (auto pos = tail_.load(std::memory_order_relaxed); pos < head_.load(std::memory_order_relaxed); ++pos) {
+            auto &s = slots_[pos & mask_];
+            if (s.seq.load(std::memory_order_relaxed) == pos + 1)
+                std::destroy_at(s.ptr());
+        }
+    }
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    template <typename... Args>
+    bool try_emplace(Args &&...args) {
+        auto pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s = slots_[pos & mask_];
+            auto seq = s.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    construct(s, pos, std::forward<Args>(args)...);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // 上一圈还没被消费，队列满
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_push(T v) {
+        return try_emplace(std::move(v));
+    }
+
+    std::optional<T> try_pop() {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s = slots_[pos & mask_];
+            auto seq = s.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return take(s, pos);
+            } else if (diff < 0) {
+                // 还没生产，队列空
+                return std::nullopt;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 阻塞版本：先领号，再等自己的槽位
+    template <typename... Args>
+    void emplace(Args &&...args) {
+        auto pos = head_.fetch_add(1, std::memory_order_relaxed);
+        auto &s = slots_[pos & mask_];
+        wait_for(s, pos);
+        construct(s, pos, std::forward<Args>(args)...);
+    }
+
+    void push(T v) {
+        emplace(std::move(v));
+    }
+
+    T pop() {
+        auto pos = tail_.fetch_add(1, std::memory_order_relaxed);
+        auto &s = slots_[pos & mask_];
+        wait_for(s, pos + 1);
+        return take(s, pos);
+    }
+
+  private:
+    template <typename... Args>
+    void construct(slot &s, std::size_t pos, Args &&...args) {
+        std::construct_at(s.ptr(), std::forward<Args>(args)...);
+        s.seq.store(pos + 1, std::memory_order_release);
+        s.seq.notify_all();
+    }
+
+    T take(slot &s, std::size_t pos) {
+        T v = std::move(*s.ptr());
+        std::destroy_at(s.ptr());
+        s.seq.store(pos + capacity(), std::memory_order_release);
+        s.seq.notify_all();
+        return v;
+    }
+
+    // 同一个槽位上可能有不同圈的多个等待者，所以notify用notify_all
+    // 先短暂自旋再让出时间片，队列不空不满时大多数情况下不会进入wait
+    static void wait_for(slot &s, std::size_t expected) {
+        for (int i = 0; i < 64; ++i) {
+            if (s.seq.load(std::memory_order_acquire) == expected)
+                return;
+            if (i >= 32)
+                std::this_thread::yield();
+        }
+        for (;;) {
+            auto seq = s.seq.load(std::memory_order_acquire);
+            if (seq == expected)
+                return;
+            s.seq.wait(seq, std::memory_order_acquire);
+        }
+    }
+
+    std::size_t mask_;
+    std::unique_ptr<slot[]> slots_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
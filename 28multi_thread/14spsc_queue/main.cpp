@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <latch>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "spsc_queue.hpp"
+
+// 把调用线程绑定到指定核上，两个线程固定在不同核，测出来的才是跨核交接的开销
+// 在线程函数开头、开始计时之前调用，整个测量过程都在绑定的核上
+void pin(unsigned cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// 忙等时调用，只有一个核时让出时间片，否则对方线程根本跑不起来
+void relax() {
+    static const bool single_core = std::thread::hardware_concurrency() < 2;
+    if (single_core)
+        std::this_thread::yield();
+}
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 基本用法
+    {
+        spsc_queue<int> q(4);
+        for (int i = 0; i < 5; ++i)
+            std::cout << q.try_push(i);
+        std::cout << "\n";
+        while (auto v = q.try_pop())
+            std::cout << *v << " ";
+        std::cout << "\n";
+    }
+
+    // 2. 看一下内存布局，head_和tail_在不同的缓存行
+    std::cout << "sizeof(spsc_queue<int>) = " << sizeof(spsc_queue<int>) << ", alignof = " << alignof(spsc_queue<int>)
+              << "\n";
+
+    const long long n = argc > 1 ? std::atoll(argv[1]) : 100'000'000;
+
+    // 3. 吞吐：单个接口 vs 批量接口，单位 M msgs/s
+    auto throughput = [n](bool batch) {
+        spsc_queue<long long> q(1 << 14);
+        long long sum = 0;
+        // 两个线程都绑好核以后主线程才开始计时
+        std::latch start(3);
+        std::thread producer([&] {
+            pin(0);
+            start.arrive_and_wait();
+            if (batch) {
+                std::array<long long, 64> buf;
+                for (long long i = 0; i < n;) {
+                    auto k = std::min<long long>(buf.size(), n - i);
+                    for (long long j = 0; j < k; ++j)
+                        buf[j] = i + j;
+                    std::size_t done = 0;
+                    while ((done += q.push_n(buf.begin() + done, k - done)) < std::size_t(k))
+                        relax();
+                    i += k;
+                }
+            } else {
+                for (long long i = 0; i < n; ++i)
+                    while (!q.try_push(i))
+                        relax();
+            }
+        });
+        std::thread consumer([&] {
+            pin(1);
+            start.arrive_and_wait();
+            if (batch) {
+                std::array<long long, 64> buf;
+                for (long long got = 0; got < n;) {
+                    auto k = q.pop_n(buf.begin(), buf.size());
+                    if (k == 0)
+                        relax();
+                    for (std::size_t j = 0; j < k; ++j)
+                        sum += buf[j];
+                    got += k;
+                }
+            } else {
+                for (long long got = 0; got < n;) {
+                    if (auto v = q.try_pop()) {
+                        sum += *v;
+                        ++got;
+                    } else {
+                        relax();
+                    }
+                }
+            }
+        });
+        start.arrive_and_wait();
+        auto beg = std::chrono::steady_clock::now();
+        producer.join();
+        consumer.join();
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beg).count();
+        std::cout << (batch ? "batch:  " : "single: ") << n / ms / 1e3 << " M msgs/s (sum " << sum << ")\n";
+    };
+    throughput(false);
+    throughput(true);
+
+    // 4. 交接延迟：生产者等上一个消息被取走后再发下一个，测的是空队列上的单次交接
+    {
+        const int rounds = 100000;
+        spsc_queue<std::int64_t> q(2);
+        std::vector<std::int64_t> lat;
+        lat.reserve(rounds);
+        std::latch start(2);
+        std::thread producer([&] {
+            pin(0);
+            start.arrive_and_wait();
+            for (int i = 0; i < rounds; ++i) {
+                while (!q.empty())
+                    relax();
+                q.try_push(now_ns());
+            }
+        });
+        std::thread consumer([&] {
+            pin(1);
+            start.arrive_and_wait();
+            for (int i = 0; i < rounds;) {
+                if (auto v = q.try_pop()) {
+                    lat.push_back(now_ns() - *v);
+                    ++i;
+                } else {
+                    relax();
+                }
+            }
+        });
+        producer.join();
+        consumer.join();
+        std::sort(lat.begin(), lat.end());
+        std::cout << "handoff latency p50 = " << lat[lat.size() / 2] << "ns, p99 = " << lat[lat.size() * 99 / 100]
+                  << "ns\n";
+    }
+
+    return 0;
+}
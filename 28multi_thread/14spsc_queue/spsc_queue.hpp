@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+// 单生产者单消费者环形队列
+// 1) 生产者只写head_，消费者只写tail_，两者用alignas放到不同的缓存行，避免伪共享(见17align_operator)
+// 2) 双方各自缓存对方的索引，只有缓存的值显示满/空时才去读对方的原子量，减少缓存行来回传递
+// 3) 批量接口一次发布多个元素，整批只需要一次release写
+// 只能有一个线程push、一个线程pop，多对多请用13mpmc_queue
+template <typename T>
+class spsc_queue {
+    static constexpr std::size_t cache_line = 64;
+
+  public:
+    // 容量必须是2的幂
+    explicit spsc_queue(std::size_t capacity)
+        : mask_(capacity - 1), slots_(std::allocator<T>().allocate(capacity)) {
+        if (capacity < 2 || (capacity & mask_) != 0) {
+            std::allocator<T>().deallocate(slots_, capacity);
+            throw std::invalid_argument("spsc_queue: capacity must be a power of 2");
+        }
+    }
+
+    spsc_queue(const spsc_queue &) = delete;
+    spsc_queue &operator=(const spsc_queue &) = delete;
+
+    ~spsc_queue() {
+        auto h = head_.load(std::memory_order_relaxed);
+        for (auto t = tail_.load(std::memory_order_relaxed); t != h; ++t)
+            std::destroy_at(slots_ + (t & mask_));
+        std::allocator<T>().deallocate(slots_, capacity());
+    }
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // 生产者接口
+    template <typename... Args>
+    bool try_emplace(Args &&...args) {
+        auto h = head_.load(std::memory_order_relaxed);
+        if (h - cached_tail_ == capacity()) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (h - cached_tail_ == capacity())
+                return false;
+        }
+        std::construct_at(slots_ + (h & mask_), std::forward<Args>(args)...);
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T v) {
+        return try_emplace(std::move(v));
+    }
+
+    // 尽量多地写入[first, first + n)，返回实际写入个数
+    template <typename It>
+    std::size_t push_n(It first, std::size_t n) {
+        auto h = head_.load(std::memory_order_relaxed);
+        auto free = capacity() - (h - cached_tail_);
+        if (free < n) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free = capacity() - (h - cached_tail_);
+        }
+        n = std::min(n, free);
+        for (std::size_t i = 0; i < n; ++i, ++first)
+            std::construct_at(slots_ + ((h + i) & mask_), *first);
+        head_.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者接口
+    std::optional<T> try_pop() {
+        auto t = tail_.load(std::memory_order_relaxed);
+        if (t == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (t == cached_head_)
+                return std::nullopt;
+        }
+        auto *p = slots_ + (t & mask_);
+        std::optional<T> v(std::move(*p));
+        std::destroy_at(p);
+        tail_.store(t + 1, std::memory_order_release);
+        return v;
+    }
+
+    // 最多取出max个元素写到out，返回实际个数
+    template <typename Out>
+    std::size_t pop_n(Out out, std::size_t max) {
+        auto t = tail_.load(std::memory_order_relaxed);
+        auto avail = cached_head_ - t;
+        if (avail < max) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            avail = cached_head_ - t;
+        }
+        auto n = std::min(max, avail);
+        for (std::size_t i = 0; i < n; ++i, ++out) {
+            auto *p = slots_ + ((t + i) & mask_);
+            *out = std::move(*p);
+            std::destroy_at(p);
+        }
+        tail_.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // 近似值，只用于统计
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    // 两边共享的只读数据
+    std::size_t mask_;
+    T *slots_;
+
+    // 生产者的缓存行：自己写的head_和缓存的tail
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+
+    // 消费者的缓存行：自己写的tail_和缓存的head
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+    // 整体对齐是64，sizeof会补齐到64的整数倍，不会和后面的对象共享缓存行
+};
@@ -0,0 +1,74 @@
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "tree_barrier.hpp"
+
+// 空阶段的往返延迟：n个线程连续过phases次屏障，平均每个阶段的微秒数
+template <typename Barrier, typename Arrive>
+double bench(int n, int phases, Arrive arrive) {
+    Barrier barrier(n);
+    auto ms = time_ms([&] {
+        std::vector<std::jthread> ts;
+        for (int id = 0; id < n; ++id) {
+            ts.emplace_back([&, id] {
+                for (int p = 0; p < phases; ++p)
+                    arrive(barrier, id);
+            });
+        }
+    });
+    return ms * 1e3 / phases;
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 替换03sync_primitive中的sync_point，阶段结束时执行一次完成函数
+    {
+        auto on_phase = []() noexcept { std::cout << "phase done\n"; };
+        tree_barrier sync_point(3, on_phase);
+        auto worker1 = [&](int id) {
+            for (int i = 0; i < 3; ++i) {
+                std::cout << "Thread " + std::to_string(id) + " reached barrier " + std::to_string(i) + "\n";
+                sync_point.arrive_and_wait(id);
+            }
+        };
+        std::thread t1(worker1, 0);
+        std::thread t2(worker1, 1);
+        std::thread t3(worker1, 2);
+
+        t1.join();
+        t2.join();
+        t3.join();
+    }
+
+    // 2. 分阶段并行循环：每个阶段各线程写自己的分量，完成函数做归约
+    {
+        const int n = 8;
+        std::vector<long long> partial(n);
+        long long total = 0;
+        parallel_for_phases(
+            n, 4, [&](int id, int phase) { partial[id] = (id + 1) * (phase + 1); },
+            [&]() noexcept {
+                for (auto v : partial)
+                    total += v;
+            });
+        std::cout << "total = " << total << "\n"; // 36 * (1 + 2 + 3 + 4) = 360
+    }
+
+    // 3. benchmark: 阶段往返延迟，单位us
+    {
+        const int phases = argc > 1 ? std::atoi(argv[1]) : 10000;
+        std::cout << "threads\tstd::barrier\ttree_barrier\n";
+        for (int n = 2; n <= 128; n *= 2) {
+            auto a = bench<std::barrier<>>(n, phases, [](auto &b, int) { b.arrive_and_wait(); });
+            auto b = bench<tree_barrier<>>(n, phases, [](auto &b, int id) { b.arrive_and_wait(id); });
+            std::cout << n << "\t" << a << "\t\t" << b << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 合并树屏障(combining tree barrier)
+// std::barrier的所有线程都在同一个计数器上做原子减，线程多了以后这条缓存行成为瓶颈
+// 这里把线程按fan_in分组挂到叶子节点上：
+// 1) 每组最后到达的线程继续向上到父节点报到，其余线程直接等待
+// 2) 到达根节点的线程就是整个阶段最后一个，它执行CompletionFunction，再推进阶段号唤醒所有人
+// 每个节点最多只有fan_in个线程竞争，竞争从O(n)降到O(fan_in)
+// 和std::barrier不同，arrive_and_wait需要传入参与者编号[0, n)，用来确定挂在哪个叶子上
+struct no_completion {
+    void operator()() noexcept {
+    }
+};
+
+template <typename CompletionFunction = no_completion>
+class tree_barrier {
+    struct alignas(64) node {
+        std::atomic<int> count{0};
+        int expected = 0;
+        int parent = -1;
+    };
+
+  public:
+    explicit tree_barrier(int n, CompletionFunction f = CompletionFunction(), int fan_in = 4)
+        : fan_in_(fan_in), completion_(std::move(f)) {
+        // n < 1时没有叶子，fan_in < 2时每层节点数不减少，下面的循环都不会结束
+        if (n < 1 || fan_in < 2)
+            throw std::invalid_argument("tree_barrier: n must be >= 1 and fan_in >= 2");
+        // 自底向上建树，每层的节点数是下一层的1/fan_in
+        std::vector<std::pair<int, int>> levels; // (本层第一个节点的下标, 本层节点数)
+        for (int first = 0, width = (n + fan_in - 1) / fan_in;; width = (width + fan_in - 1) / fan_in) {
+            levels.emplace_back(first, width);
+            first += width;
+            if (width == 1)
+                break;
+        }
+        // 节点含原子量不能移动，一次性分配好
+        nodes_ = std::vector<node>(levels.back().first + 1);
+
+        for (std::size_t l = 0; l < levels.size(); ++l) {
+            auto [beg, cnt] = levels[l];
+            // 叶子层的下一层是线程，其余层的下一层是节点
+            int below = l == 0 ? n : levels[l - 1].second;
+            for (int i = 0; i < cnt; ++i) {
+                nodes_[beg + i].expected = std::min(fan_in, below - i * fan_in);
+                if (l + 1 < levels.size())
+                    nodes_[beg + i].parent = levels[l + 1].first + i / fan_in;
+            }
+        }
+    }
+
+    tree_barrier(const tree_barrier &) = delete;
+    tree_barrier &operator=(const tree_barrier &) = delete;
+
+    void arrive_and_wait(int id) {
+        auto phase = phase_.load(std::memory_order_acquire);
+        int idx = id / fan_in_;
+        for (;;) {
+            auto &nd = nodes_[idx];
+            if (nd.count.fetch_add(1, std::memory_order_acq_rel) + 1 != nd.expected)
+                break;
+            // 本组最后一个，重置计数后替整组继续向上报到
+            nd.count.store(0, std::memory_order_relaxed);
+            if (nd.parent < 0) {
+                completion_();
+                phase_.store(phase + 1, std::memory_order_release);
+                phase_.notify_all();
+                return;
+            }
+            idx = nd.parent;
+        }
+
+        // 先自旋一小会儿，阶段很短时不用进内核
+        for (int i = 0; i < 128; ++i) {
+            if (phase_.load(std::memory_order_acquire) != phase)
+                return;
+            if (i >= 64)
+                std::this_thread::yield();
+        }
+        while (phase_.load(std::memory_order_acquire) == phase)
+            phase_.wait(phase, std::memory_order_acquire);
+    }
+
+  private:
+    int fan_in_;
+    std::vector<node> nodes_;
+    CompletionFunction completion_;
+    alignas(64) std::atomic<std::uint32_t> phase_{0};
+};
+
+// 分阶段并行循环：n个线程各自执行body(id, phase)，每个阶段结束后在屏障上汇合
+// completion在每个阶段结束时由最后到达的线程执行一次，适合做阶段间的归约或交换缓冲区
+template <typename Body, typename CompletionFunction = no_completion>
+void parallel_for_phases(int n, int phases, Body body, CompletionFunction completion = CompletionFunction()) {
+    tree_barrier<CompletionFunction> barrier(n, std::move(completion));
+    std::vector<std::jthread> ts;
+    ts.reserve(n);
+    for (int id = 0; id < n; ++id) {
+        ts.emplace_back([&, id] {
+            for (int p = 0; p < phases; ++p) {
+                body(id, p);
+                barrier.arrive_and_wait(id);
+            }
+        });
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+// 自适应并发限制器
+// counting_semaphore<3>把并发数写死成3，但合适的并发数取决于后端当前的延迟
+// 这里保持acquire/release/try_acquire_for的用法，获取时返回一个permit记下开始时间，
+// release(permit)用steady_clock算出从获取到归还的耗时，交给策略调整许可数量：
+// 1) aimd_policy：延迟明显超过基线就乘性减小，否则加性增大，类似TCP拥塞控制
+// 2) vegas_policy：用 limit * (1 - 基线延迟 / 当前延迟) 估算排队的请求数，排队少就加，多就减
+// 基线延迟取最近一个窗口内的最小值，窗口结束后重新测量，能跟上后端的变化
+// 开始时间在permit里而不是线程里，所以可以在一个线程获取、在另一个线程(比如异步完成回调)归还
+
+struct aimd_policy {
+    double tolerance = 2.0; // 延迟超过基线的倍数就认为过载
+    double backoff = 0.9;
+
+    double operator()(double limit, double rtt, double min_rtt, int in_flight) const {
+        if (rtt > min_rtt * tolerance)
+            return limit * backoff;
+        // 只有许可真的被用满时才增长，避免空闲时limit无限上涨
+        if (in_flight + 1 >= static_cast<int>(limit))
+            return limit + 1.0 / limit;
+        return limit;
+    }
+};
+
+struct vegas_policy {
+    double alpha = 3; // 排队少于alpha时增大
+    double beta = 6;  // 排队多于beta时减小
+
+    double operator()(double limit, double rtt, double min_rtt, int in_flight) const {
+        auto queue = limit * (1 - min_rtt / rtt);
+        if (queue < alpha && in_flight + 1 >= static_cast<int>(limit))
+            return limit + 1.0 / limit * alpha;
+        if (queue > beta)
+            return limit - 1.0 / limit * beta;
+        return limit;
+    }
+};
+
+template <typename Policy = vegas_policy>
+class adaptive_limiter {
+    using clock = std::chrono::steady_clock;
+
+  public:
+    // 一个许可，记录获取的时间；获取失败时为空，可以直接当bool判断
+    class permit {
+      public:
+        permit() = default;
+
+        explicit operator bool() const noexcept {
+            return start_ != clock::time_point();
+        }
+
+      private:
+        friend adaptive_limiter;
+        explicit permit(clock::time_point start) : start_(start) {
+        }
+        clock::time_point start_;
+    };
+
+    explicit adaptive_limiter(int initial, int min_limit = 1, int max_limit = 1024, Policy policy = Policy())
+        : policy_(std::move(policy)), limit_(initial), min_limit_(min_limit), max_limit_(max_limit),
+          permits_(initial) {
+    }
+
+    adaptive_limiter(const adaptive_limiter &) = delete;
+    adaptive_limiter &operator=(const adaptive_limiter &) = delete;
+
+    permit acquire() {
+        auto p = try_acquire();
+        if (!p) {
+            std::unique_lock lock(m_);
+            ++waiters_;
+            cv_.wait(lock, [&] { return bool(p = try_acquire()); });
+            --waiters_;
+        }
+        return p;
+    }
+
+    // 快路径：一次CAS，不碰mutex
+    // 这里的load和release里的fetch_sub/waiters_检查配对，必须是seq_cst，否则等待者可能错过唤醒
+    permit try_acquire() {
+        auto n = in_flight_.load(std::memory_order_seq_cst);
+        while (n < permits_.load(std::memory_order_relaxed)) {
+            if (in_flight_.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return permit(clock::now());
+        }
+        return permit();
+    }
+
+    template <typename Rep, typename Period>
+    permit try_acquire_for(const std::chrono::duration<Rep, Period> &d) {
+        if (auto p = try_acquire())
+            return p;
+        permit p;
+        std::unique_lock lock(m_);
+        ++waiters_;
+        cv_.wait_for(lock, d, [&] { return bool(p = try_acquire()); });
+        --waiters_;
+        return p;
+    }
+
+    // 可以在任何线程调用，每个permit只能归还一次
+    void release(permit p) {
+        auto rtt = std::chrono::duration<double, std::micro>(clock::now() - p.start_).count();
+        in_flight_.fetch_sub(1, std::memory_order_seq_cst);
+        auto before = update(rtt);
+        // 没有人在等时不碰mutex和条件变量
+        if (waiters_.load(std::memory_order_seq_cst) == 0)
+            return;
+        {
+            // 加锁后再通知，保证等待者不会在检查条件和进入休眠之间错过
+            std::lock_guard lg(m_);
+        }
+        // 许可变多时可能可以放行多个等待者
+        if (limit() > before)
+            cv_.notify_all();
+        else
+            cv_.notify_one();
+    }
+
+    int limit() const noexcept {
+        return permits_.load(std::memory_order_relaxed);
+    }
+
+    int in_flight() const noexcept {
+        return in_flight_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // 返回更新前的许可数
+    int update(double rtt) {
+        if (rtt <= 0)
+            return limit();
+        std::lock_guard lg(stats_m_);
+        min_rtt_ = std::min(min_rtt_, rtt);
+        window_min_ = std::min(window_min_, rtt);
+        if (++samples_ >= window) {
+            // 窗口结束，把这个窗口的最小值作为新的基线
+            min_rtt_ = window_min_;
+            window_min_ = 1e300;
+            samples_ = 0;
+        }
+        limit_ = std::clamp(policy_(limit_, rtt, min_rtt_, in_flight()), double(min_limit_), double(max_limit_));
+        return permits_.exchange(static_cast<int>(limit_), std::memory_order_relaxed);
+    }
+
+    static constexpr int window = 1000;
+
+    Policy policy_;
+    std::mutex stats_m_;
+    double limit_;
+    double min_rtt_ = 1e300;
+    double window_min_ = 1e300;
+    int samples_ = 0;
+    int min_limit_, max_limit_;
+
+    std::atomic<int> permits_;
+    alignas(64) std::atomic<int> in_flight_{0};
+    std::atomic<int> waiters_{0};
+    std::mutex m_;
+    std::condition_variable cv_;
+};
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adaptive_limiter.hpp"
+
+using namespace std::chrono_literals;
+
+// 模拟的后端：并发数不超过capacity时每个请求耗时base，
+// 超过以后争抢加剧，耗时按 (并发数 / capacity)^2 增长，吞吐量反而下降
+class backend {
+  public:
+    backend(int capacity, std::chrono::microseconds base) : capacity_(capacity), base_(base) {
+    }
+
+    void call() {
+        auto n = active_.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto factor = std::max(1.0, double(n) / capacity_);
+        std::this_thread::sleep_for(base_ * (factor * factor));
+        active_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+  private:
+    int capacity_;
+    std::chrono::microseconds base_;
+    std::atomic<int> active_{0};
+};
+
+// bench里统一用 auto p = acquire(); release(p); 的形式，下面两个包装让不限制和counting_semaphore也能这样用
+struct no_limit {
+    int acquire() {
+        return 0;
+    }
+    void release(int) {
+    }
+};
+
+struct semaphore_limiter {
+    std::counting_semaphore<> sem;
+
+    int acquire() {
+        sem.acquire();
+        return 0;
+    }
+    void release(int) {
+        sem.release();
+    }
+};
+
+// clients个线程不停地发请求，返回每秒完成的请求数
+template <typename Limiter>
+double bench(Limiter &limiter, int clients, std::chrono::milliseconds duration) {
+    backend be(8, 200us);
+    std::atomic<long long> done{0};
+    std::atomic<bool> stop{false};
+    {
+        std::vector<std::jthread> ts;
+        for (int i = 0; i < clients; ++i) {
+            ts.emplace_back([&] {
+                while (!stop.load(std::memory_order_relaxed)) {
+                    auto p = limiter.acquire();
+                    be.call();
+                    limiter.release(p);
+                    done.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        stop = true;
+    }
+    return done.load() * 1000.0 / duration.count();
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 和03sync_primitive中counting_semaphore<3>一样的用法，初始并发数为3
+    // 区别是acquire返回的permit要交还给release，它记录了获取的时间
+    {
+        adaptive_limiter sem(3);
+        auto worker = [&](int id) {
+            auto p = sem.acquire();
+            std::cout << "Thread " + std::to_string(id) + " working\n";
+
+            std::this_thread::sleep_for(100ms);
+
+            std::cout << "Thread " + std::to_string(id) + " done\n";
+            sem.release(p);
+        };
+
+        std::thread ts[6];
+        for (int i = 0; i < 6; ++i)
+            ts[i] = std::thread(worker, i);
+
+        for (auto &t : ts)
+            t.join();
+        std::cout << "limit after run: " << sem.limit() << "\n";
+    }
+
+    // 2. 带超时的获取
+    {
+        adaptive_limiter<aimd_policy> sem(1);
+        auto p = sem.acquire();
+        std::jthread t([&] {
+            if (!sem.try_acquire_for(50ms))
+                std::cout << "try_acquire_for timeout\n";
+        });
+        t.join();
+        sem.release(p);
+    }
+
+    // 3. 在一个线程获取、在另一个线程归还，延迟照样计入
+    {
+        adaptive_limiter<aimd_policy> sem(4);
+        std::vector<adaptive_limiter<aimd_policy>::permit> ps;
+        for (int i = 0; i < 4; ++i)
+            ps.push_back(sem.acquire());
+        std::jthread completer([&] {
+            std::this_thread::sleep_for(10ms);
+            for (auto p : ps)
+                sem.release(p);
+        });
+        completer.join();
+        std::cout << "in flight after cross-thread release: " << sem.in_flight() << ", limit " << sem.limit()
+                  << "\n";
+    }
+
+    // 4. 性能对比：64个客户端压一个容量为8的后端
+    // 固定上限太小浪费后端能力，太大会把后端压垮，自适应限制器应该自己找到接近8的并发数
+    {
+        int clients = argc > 1 ? std::atoi(argv[1]) : 64;
+        auto duration = std::chrono::milliseconds(argc > 2 ? std::atoi(argv[2]) : 2000);
+
+        no_limit unlimited;
+        std::cout << "unlimited:          " << bench(unlimited, clients, duration) << " req/s\n";
+
+        semaphore_limiter small{std::counting_semaphore<>(3)};
+        std::cout << "semaphore(3):       " << bench(small, clients, duration) << " req/s\n";
+
+        semaphore_limiter large{std::counting_semaphore<>(64)};
+        std::cout << "semaphore(64):      " << bench(large, clients, duration) << " req/s\n";
+
+        adaptive_limiter<aimd_policy> aimd(3);
+        std::cout << "adaptive(aimd):     " << bench(aimd, clients, duration) << " req/s, limit "
+                  << aimd.limit() << "\n";
+
+        adaptive_limiter<vegas_policy> vegas(3);
+        std::cout << "adaptive(vegas):    " << bench(vegas, clients, duration) << " req/s, limit "
+                  << vegas.limit() << "\n";
+    }
+    return 0;
+}
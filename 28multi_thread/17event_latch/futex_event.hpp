@@ -0,0 +1,172 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "../../common/cpu_relax.hpp"
+
+// 基于atomic::wait/notify_all(linux下是futex)的一次性事件、闩和事件计数
+// 03sync_primitive里用binary_semaphore通知只能唤醒一个等待者，几百个等待者时只能一个个地release，
+// 每次唤醒一个线程，被唤醒的线程又去抢同一个计数，形成惊群
+// 这里的三个原语共同的做法：
+// 1) 额外维护一个等待者计数waiters_，通知方发现没人在等时直接返回，不进内核
+// 2) 有人在等时用一次notify_all批量唤醒全部等待者，只有一次系统调用
+// 3) 等待方进入休眠前先自旋一小会儿，通知很快到来时不用进内核
+// 等待者计数和状态字之间是Dekker式的配对：等待方先加计数再读状态，通知方先写状态再读计数，
+// 两边都用seq_cst，保证至少一方看到对方的写入，不会出现通知方跳过唤醒而等待方永远休眠
+namespace detail {
+// 自旋等待pred成立，成功返回true
+// 单核机器上自旋只会抢走通知方和刚被唤醒的线程的时间片，直接跳过
+template <typename Pred>
+bool spin_until(Pred pred) {
+    static const int spins = std::thread::hardware_concurrency() > 1 ? 128 : 0;
+    for (int i = 0; i < spins; ++i) {
+        if (pred())
+            return true;
+        if (i < spins / 2)
+            cpu_relax();
+        else
+            std::this_thread::yield();
+    }
+    return false;
+}
+} // namespace detail
+
+// 手动复位事件：set之后所有wait都立即返回，直到reset
+class futex_event {
+  public:
+    explicit futex_event(bool initially_set = false) noexcept : state_(initially_set) {
+    }
+
+    futex_event(const futex_event &) = delete;
+    futex_event &operator=(const futex_event &) = delete;
+
+    void set() noexcept {
+        if (state_.exchange(1, std::memory_order_seq_cst) == 0 && waiters_.load(std::memory_order_seq_cst) != 0)
+            state_.notify_all();
+    }
+
+    void reset() noexcept {
+        state_.store(0, std::memory_order_relaxed);
+    }
+
+    bool is_set() const noexcept {
+        return state_.load(std::memory_order_acquire) != 0;
+    }
+
+    void wait() noexcept {
+        if (detail::spin_until([&] { return is_set(); }))
+            return;
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        while (state_.load(std::memory_order_seq_cst) == 0)
+            state_.wait(0, std::memory_order_acquire);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<std::uint32_t> state_;
+    std::atomic<std::uint32_t> waiters_{0};
+};
+
+// 和std::latch接口一致的闩，计数减到0时批量唤醒
+class futex_latch {
+  public:
+    explicit futex_latch(std::ptrdiff_t expected) noexcept : count_(static_cast<std::int32_t>(expected)) {
+    }
+
+    futex_latch(const futex_latch &) = delete;
+    futex_latch &operator=(const futex_latch &) = delete;
+
+    void count_down(std::ptrdiff_t n = 1) noexcept {
+        auto d = static_cast<std::int32_t>(n);
+        // 只有把计数减到0的那一次需要唤醒
+        if (count_.fetch_sub(d, std::memory_order_seq_cst) == d && waiters_.load(std::memory_order_seq_cst) != 0)
+            count_.notify_all();
+    }
+
+    bool try_wait() const noexcept {
+        return count_.load(std::memory_order_acquire) == 0;
+    }
+
+    void wait() const noexcept {
+        if (detail::spin_until([&] { return try_wait(); }))
+            return;
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        for (auto c = count_.load(std::memory_order_seq_cst); c != 0; c = count_.load(std::memory_order_acquire))
+            count_.wait(c, std::memory_order_acquire);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void arrive_and_wait(std::ptrdiff_t n = 1) noexcept {
+        count_down(n);
+        wait();
+    }
+
+  private:
+    std::atomic<std::int32_t> count_;
+    mutable std::atomic<std::uint32_t> waiters_{0};
+};
+
+// 事件计数(eventcount)：给已有的无锁结构加上阻塞等待，本身不保存"条件"
+// 等待方：
+//     for (;;) {
+//         if (try_pop()) break;
+//         auto key = ec.prepare_wait();
+//         if (try_pop()) { ec.cancel_wait(); break; }
+//         ec.wait(key);
+//     }
+// 通知方：修改数据结构后调用notify/notify_all，没有等待者时只是一次fence加一次load
+class event_count {
+  public:
+    using key = std::uint32_t;
+
+    event_count() = default;
+    event_count(const event_count &) = delete;
+    event_count &operator=(const event_count &) = delete;
+
+    // 和bump里的fence配对：调用方之后对数据结构的检查(哪怕只是acquire load)不能提前到加计数之前，
+    // 否则通知方可能还没看到计数，等待方也没看到新数据，唤醒就丢了
+    key prepare_wait() noexcept {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        auto k = epoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return k;
+    }
+
+    void cancel_wait() noexcept {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // prepare_wait之后如果有过notify，立即返回
+    void wait(key k) noexcept {
+        if (!detail::spin_until([&] { return epoch_.load(std::memory_order_acquire) != k; })) {
+            while (epoch_.load(std::memory_order_acquire) == k)
+                epoch_.wait(k, std::memory_order_acquire);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify() noexcept {
+        if (bump())
+            epoch_.notify_one();
+    }
+
+    void notify_all() noexcept {
+        if (bump())
+            epoch_.notify_all();
+    }
+
+  private:
+    // 调用方对数据结构的修改必须在读waiters_之前对等待方可见，所以先放一个完整的fence
+    bool bump() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0)
+            return false;
+        epoch_.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    std::atomic<key> epoch_{0};
+    std::atomic<std::uint32_t> waiters_{0};
+};
@@ -0,0 +1,253 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <latch>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "../14spsc_queue/spsc_queue.hpp"
+#include "futex_event.hpp"
+
+// 对照组：不统计等待者，每次set都调用notify_all
+class naive_event {
+  public:
+    void set() noexcept {
+        flag_.store(1, std::memory_order_release);
+        flag_.notify_all();
+    }
+    void reset() noexcept {
+        flag_.store(0, std::memory_order_relaxed);
+    }
+    void wait() noexcept {
+        while (flag_.load(std::memory_order_acquire) == 0)
+            flag_.wait(0, std::memory_order_acquire);
+    }
+
+  private:
+    std::atomic<std::uint32_t> flag_{0};
+};
+
+// 把各种原语包装成"n个等待者等一次信号"的统一接口
+struct use_naive_event {
+    naive_event ev;
+    explicit use_naive_event(int) {
+    }
+    void wait() {
+        ev.wait();
+    }
+    void signal() {
+        ev.set();
+    }
+};
+
+struct use_futex_event {
+    futex_event ev;
+    explicit use_futex_event(int) {
+    }
+    void wait() {
+        ev.wait();
+    }
+    void signal() {
+        ev.set();
+    }
+};
+
+// 用信号量通知n个等待者只能release(n)
+struct use_semaphore {
+    std::counting_semaphore<> sem{0};
+    int n;
+    explicit use_semaphore(int n) : n(n) {
+    }
+    void wait() {
+        sem.acquire();
+    }
+    void signal() {
+        sem.release(n);
+    }
+};
+
+struct use_std_latch {
+    std::latch l{1};
+    explicit use_std_latch(int) {
+    }
+    void wait() {
+        l.wait();
+    }
+    void signal() {
+        l.count_down();
+    }
+};
+
+struct use_futex_latch {
+    futex_latch l{1};
+    explicit use_futex_latch(int) {
+    }
+    void wait() {
+        l.wait();
+    }
+    void signal() {
+        l.count_down();
+    }
+};
+
+// 没有等待者时一次通知的开销(纳秒)
+template <typename Signal>
+double bench_idle(long long iters, Signal signal) {
+    return time_ms([&] {
+               for (long long i = 0; i < iters; ++i)
+                   signal();
+           }) *
+           1e6 / iters;
+}
+
+struct wake_result {
+    double signal_us; // 通知方调用signal本身的耗时
+    double wake_us;   // 从signal到最后一个等待者醒来
+};
+
+// n个等待者阻塞在同一个信号上，每一轮新建一个对象，测通知和全部唤醒的耗时
+template <typename Prim>
+wake_result bench_wake(int n, int rounds) {
+    std::vector<Prim *> prims;
+    for (int r = 0; r < rounds; ++r)
+        prims.push_back(new Prim(n));
+    std::atomic<int> woke{0};
+    double signal_us = 0, wake_us = 0;
+    {
+        std::vector<std::jthread> ts;
+        for (int i = 0; i < n; ++i) {
+            ts.emplace_back([&] {
+                for (int r = 0; r < rounds; ++r) {
+                    prims[r]->wait();
+                    woke.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (int r = 0; r < rounds; ++r) {
+            // 给等待者时间进入休眠
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            auto t0 = std::chrono::steady_clock::now();
+            prims[r]->signal();
+            auto t1 = std::chrono::steady_clock::now();
+            while (woke.load(std::memory_order_relaxed) < n * (r + 1))
+                std::this_thread::yield();
+            auto t2 = std::chrono::steady_clock::now();
+            signal_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+            wake_us += std::chrono::duration<double, std::micro>(t2 - t0).count();
+        }
+    }
+    for (auto *p : prims)
+        delete p;
+    return {signal_us / rounds, wake_us / rounds};
+}
+
+template <typename Prim>
+void report_wake(const char *name, int n, int rounds) {
+    auto r = bench_wake<Prim>(n, rounds);
+    std::cout << "  " << name << ": signal " << r.signal_us << " us, all woken " << r.wake_us << " us\n";
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 替换03sync_primitive中的latch：三个线程各自完成后count_down，主线程等待
+    {
+        futex_latch done(3);
+        auto worker = [&](int id) {
+            std::cout << "Thread " + std::to_string(id) + " finished\n";
+            done.count_down();
+        };
+        std::jthread t1(worker, 1);
+        std::jthread t2(worker, 2);
+        std::jthread t3(worker, 3);
+        done.wait();
+        std::cout << "All threads done\n";
+    }
+
+    // 2. 一次性通知事件：一次set唤醒全部等待者
+    {
+        futex_event go;
+        std::vector<std::jthread> ts;
+        std::atomic<int> started{0};
+        for (int i = 0; i < 4; ++i) {
+            ts.emplace_back([&] {
+                go.wait();
+                started.fetch_add(1);
+            });
+        }
+        std::cout << "Waiting...\n";
+        go.set();
+        ts.clear();
+        std::cout << "Go! started " << started << "\n";
+    }
+
+    // 3. 事件计数：给无锁的spsc_queue加上阻塞pop
+    {
+        spsc_queue<int> q(64);
+        event_count ec;
+        long long sum = 0;
+        std::jthread consumer([&] {
+            for (int got = 0; got < 1000;) {
+                if (auto v = q.try_pop()) {
+                    sum += *v;
+                    ++got;
+                    continue;
+                }
+                // prepare_wait末尾有seq_cst fence，这里再检查队列用普通的acquire load就够了
+                auto key = ec.prepare_wait();
+                if (!q.empty()) {
+                    ec.cancel_wait();
+                    continue;
+                }
+                ec.wait(key);
+            }
+        });
+        for (int i = 1; i <= 1000; ++i) {
+            while (!q.try_push(i))
+                std::this_thread::yield();
+            ec.notify();
+        }
+        consumer.join();
+        std::cout << "event_count sum " << sum << " (expect 500500)\n";
+    }
+
+    // 4. 性能对比
+    {
+        int n = argc > 1 ? std::atoi(argv[1]) : 256;
+        int rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+        const long long iters = 10'000'000;
+
+        // 1) 0个等待者：计数为0时直接跳过系统调用
+        // libstdc++的notify_all内部也有一个全局的等待者计数，naive_event同样不进内核，
+        // 而且它的store不是seq_cst，所以这里反而更快；futex_event多出的是一次xchg，
+        // 换来的是不依赖标准库实现的、可移植的保证
+        {
+            naive_event naive;
+            futex_event ev;
+            event_count ec;
+            std::cout << "0 waiters (ns per signal)\n";
+            std::cout << "  naive_event:  " << bench_idle(iters, [&] {
+                naive.reset();
+                naive.set();
+            }) << "\n";
+            std::cout << "  futex_event:  " << bench_idle(iters, [&] {
+                ev.reset();
+                ev.set();
+            }) << "\n";
+            std::cout << "  event_count:  " << bench_idle(iters, [&] { ec.notify_all(); }) << "\n";
+        }
+
+        // 2) 1个和n个等待者
+        for (int waiters : {1, n}) {
+            std::cout << waiters << " waiters\n";
+            report_wake<use_semaphore>("semaphore   ", waiters, rounds);
+            report_wake<use_std_latch>("std::latch  ", waiters, rounds);
+            report_wake<use_futex_latch>("futex_latch ", waiters, rounds);
+            report_wake<use_naive_event>("naive_event ", waiters, rounds);
+            report_wake<use_futex_event>("futex_event ", waiters, rounds);
+        }
+    }
+    return 0;
+}
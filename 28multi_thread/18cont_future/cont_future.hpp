@@ -0,0 +1,603 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// 支持续体(continuation)的future/promise
+// std::future只能get()阻塞等待，每个等待结果的任务都要占住一个线程
+// 这里的future可以用then挂一个回调，结果就绪时由设置结果的线程直接调用，或者投递到指定的执行器上：
+// 1) then(f)：在设置结果的线程上内联执行f；then(ex, f)：ex.post到执行器上执行
+// 2) when_all/when_any：把多个future合成一个，不需要任何线程阻塞
+// 3) 共享状态里直接存放结果，回调用小缓冲区存放，不额外分配
+// 4) 共享状态本身按大小走线程本地的空闲链表，稳定运行后不再调用全局的operator new
+// 异常和std::future一样沿着then链传递，f不会被调用
+namespace cf {
+
+template <typename T>
+class future;
+template <typename T>
+class promise;
+
+// 执行器：任何有post(f)的类型，比如05thread_pool的thread_pool
+template <typename E>
+concept executor = requires(E &e) { e.post([] {}); };
+
+// 直接在当前线程调用
+struct inline_executor {
+    template <typename F>
+    void post(F &&f) {
+        std::forward<F>(f)();
+    }
+};
+
+template <typename T>
+struct when_any_result {
+    std::size_t index;
+    T value;
+};
+
+namespace detail {
+
+template <typename T>
+using non_void_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+// 按大小分类的线程本地空闲链表，由释放的线程回收，由分配的线程复用
+template <std::size_t Size>
+class state_pool {
+    static constexpr std::size_t max_cached = 4096;
+
+    struct free_list {
+        std::vector<void *> blocks;
+        ~free_list() {
+            for (auto *p : blocks)
+                ::operator delete(p);
+        }
+    };
+
+    static free_list &local() {
+        static thread_local free_list l;
+        return l;
+    }
+
+  public:
+    static void *allocate() {
+        auto &l = local().blocks;
+        if (l.empty())
+            return ::operator new(Size);
+        auto *p = l.back();
+        l.pop_back();
+        return p;
+    }
+
+    static void deallocate(void *p) noexcept {
+        auto &l = local().blocks;
+        if (l.size() < max_cached) {
+            try {
+                l.push_back(p);
+                return;
+            } catch (...) {
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+// 结果：值或者异常
+template <typename T>
+struct outcome {
+    std::optional<non_void_t<T>> value;
+    std::exception_ptr error;
+};
+
+// 只调用一次的回调，小于inline_size的可调用对象直接放在缓冲区里
+template <typename Arg>
+class callback {
+    static constexpr std::size_t inline_size = 48;
+
+  public:
+    callback() = default;
+    callback(const callback &) = delete;
+    callback &operator=(const callback &) = delete;
+
+    ~callback() {
+        reset();
+    }
+
+    template <typename F>
+    void emplace(F &&f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= inline_size && alignof(Fn) <= alignof(std::max_align_t)) {
+            ::new (static_cast<void *>(buf_)) Fn(std::forward<F>(f));
+            invoke_ = [](void *p, Arg &a) { (*static_cast<Fn *>(p))(a); };
+            destroy_ = [](void *p) noexcept { static_cast<Fn *>(p)->~Fn(); };
+        } else {
+            ::new (static_cast<void *>(buf_)) Fn *(new Fn(std::forward<F>(f)));
+            invoke_ = [](void *p, Arg &a) { (**static_cast<Fn **>(p))(a); };
+            destroy_ = [](void *p) noexcept { delete *static_cast<Fn **>(p); };
+        }
+    }
+
+    void operator()(Arg &a) {
+        invoke_(buf_, a);
+        reset();
+    }
+
+    void reset() noexcept {
+        if (destroy_) {
+            destroy_(buf_);
+            destroy_ = nullptr;
+        }
+    }
+
+  private:
+    alignas(std::max_align_t) std::byte buf_[inline_size];
+    void (*invoke_)(void *, Arg &) = nullptr;
+    void (*destroy_)(void *) noexcept = nullptr;
+};
+
+// promise和future共享的状态，引用计数管理生命周期
+// flags_的三个位：结果已就绪、已挂回调、有线程在get()中等待
+// 设置结果和挂回调都是对flags_的fetch_or，后到的一方负责调用回调，不需要锁
+template <typename T>
+class shared_state {
+    enum : std::uint32_t { ready = 1, has_callback = 2, waiting = 4 };
+
+  public:
+    explicit shared_state(std::uint32_t refs) noexcept : refs_(refs) {
+    }
+
+    // 超对齐的T不走空闲链表
+    static constexpr bool pooled() noexcept {
+        return alignof(shared_state) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    }
+
+    static void *operator new(std::size_t n) {
+        if constexpr (pooled())
+            return state_pool<(sizeof(shared_state) + 15) / 16 * 16>::allocate();
+        else
+            return ::operator new(n);
+    }
+
+    static void operator delete(void *p) noexcept {
+        if constexpr (pooled())
+            state_pool<(sizeof(shared_state) + 15) / 16 * 16>::deallocate(p);
+        else
+            ::operator delete(p);
+    }
+
+    void add_ref() noexcept {
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    template <typename... Args>
+    void set_value(Args &&...args) {
+        emplace_value(std::forward<Args>(args)...);
+        publish();
+    }
+
+    // set_value的两步分开给promise用：构造结果可能抛异常，抛出时状态不变；publish之后结果才对future可见
+    template <typename... Args>
+    void emplace_value(Args &&...args) {
+        result_.value.emplace(std::forward<Args>(args)...);
+    }
+
+    void publish() {
+        auto old = flags_.fetch_or(ready, std::memory_order_acq_rel);
+        // 没有线程阻塞在get()上时不调用notify
+        if (old & waiting)
+            flags_.notify_all();
+        if (old & has_callback)
+            run_callback();
+    }
+
+    void set_exception(std::exception_ptr e) {
+        result_.error = std::move(e);
+        publish();
+    }
+
+    // 挂回调，调用方持有的那份引用转交给回调，回调执行完后释放
+    template <typename F>
+    void set_callback(F &&f) {
+        callback_.emplace(std::forward<F>(f));
+        if (flags_.fetch_or(has_callback, std::memory_order_acq_rel) & ready)
+            run_callback();
+    }
+
+    bool is_ready() const noexcept {
+        return flags_.load(std::memory_order_acquire) & ready;
+    }
+
+    void wait() {
+        if (is_ready())
+            return;
+        auto f = flags_.fetch_or(waiting, std::memory_order_acq_rel) | waiting;
+        while (!(f & ready)) {
+            flags_.wait(f, std::memory_order_acquire);
+            f = flags_.load(std::memory_order_acquire);
+        }
+    }
+
+    outcome<T> take() noexcept {
+        return std::move(result_);
+    }
+
+  private:
+    void run_callback() {
+        callback_(*this);
+        release();
+    }
+
+    std::atomic<std::uint32_t> refs_;
+    std::atomic<std::uint32_t> flags_{0};
+    outcome<T> result_;
+    callback<shared_state> callback_;
+};
+
+// 把结果交给f，f的返回值写入next
+template <typename R, typename T, typename F>
+void fulfill(shared_state<R> *next, F &f, outcome<T> &&o) {
+    try {
+        if (o.error) {
+            next->set_exception(std::move(o.error));
+        } else if constexpr (std::is_void_v<R>) {
+            if constexpr (std::is_void_v<T>)
+                std::invoke(f);
+            else
+                std::invoke(f, std::move(*o.value));
+            next->set_value();
+        } else if constexpr (std::is_void_v<T>) {
+            next->set_value(std::invoke(f));
+        } else {
+            next->set_value(std::invoke(f, std::move(*o.value)));
+        }
+    } catch (...) {
+        next->set_exception(std::current_exception());
+    }
+    next->release();
+}
+
+template <typename T, typename F>
+struct then_result {
+    using type = std::invoke_result_t<F &, T &&>;
+};
+
+template <typename F>
+struct then_result<void, F> {
+    using type = std::invoke_result_t<F &>;
+};
+
+// when_all/when_any需要直接拿到共享状态
+struct access {
+    template <typename T>
+    static shared_state<T> *release(future<T> &f) noexcept {
+        return std::exchange(f.state_, nullptr);
+    }
+
+    template <typename T>
+    static future<T> make(shared_state<T> *s) noexcept {
+        return future<T>(s);
+    }
+};
+
+inline inline_executor inline_exec;
+
+} // namespace detail
+
+template <typename T>
+class future {
+    friend struct detail::access;
+    friend class promise<T>;
+
+    explicit future(detail::shared_state<T> *s) noexcept : state_(s) {
+    }
+
+  public:
+    using value_type = T;
+
+    future() = default;
+
+    future(future &&other) noexcept : state_(std::exchange(other.state_, nullptr)) {
+    }
+
+    future &operator=(future &&other) noexcept {
+        if (this != &other) {
+            reset();
+            state_ = std::exchange(other.state_, nullptr);
+        }
+        return *this;
+    }
+
+    ~future() {
+        reset();
+    }
+
+    bool valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    bool is_ready() const noexcept {
+        return state_ && state_->is_ready();
+    }
+
+    void wait() const {
+        state_->wait();
+    }
+
+    // 和std::future一样只能get一次
+    T get() {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        state_->wait();
+        auto o = state_->take();
+        reset();
+        if (o.error)
+            std::rethrow_exception(o.error);
+        if constexpr (!std::is_void_v<T>)
+            return std::move(*o.value);
+    }
+
+    // 结果就绪后在设置结果的线程上调用f(value)，返回f结果的future，本future失效
+    template <typename F>
+    auto then(F &&f) {
+        return then(detail::inline_exec, std::forward<F>(f));
+    }
+
+    // 结果就绪后把f(value)投递到ex上执行，ex的生命周期由调用方保证
+    template <executor E, typename F>
+    auto then(E &ex, F &&f) -> future<typename detail::then_result<T, std::decay_t<F>>::type> {
+        using R = typename detail::then_result<T, std::decay_t<F>>::type;
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        // 两份引用：一份给回调(完成后写入结果)，一份给返回的future
+        auto *next = new detail::shared_state<R>(2);
+        std::exchange(state_, nullptr)
+            ->set_callback([next, &ex, f = std::forward<F>(f)](detail::shared_state<T> &s) mutable {
+                if constexpr (std::is_same_v<E, inline_executor>)
+                    detail::fulfill(next, f, s.take());
+                else
+                    ex.post([next, f = std::move(f), o = s.take()]() mutable { detail::fulfill(next, f, std::move(o)); });
+            });
+        return detail::access::make(next);
+    }
+
+  private:
+    void reset() noexcept {
+        if (state_)
+            std::exchange(state_, nullptr)->release();
+    }
+
+    detail::shared_state<T> *state_ = nullptr;
+};
+
+template <typename T>
+class promise {
+  public:
+    promise() : state_(new detail::shared_state<T>(1)) {
+    }
+
+    promise(promise &&other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), satisfied_(other.satisfied_), retrieved_(other.retrieved_) {
+    }
+
+    promise &operator=(promise &&other) noexcept {
+        if (this != &other) {
+            abandon();
+            state_ = std::exchange(other.state_, nullptr);
+            satisfied_ = other.satisfied_;
+            retrieved_ = other.retrieved_;
+        }
+        return *this;
+    }
+
+    // 没有设置结果就析构，和std::promise一样给future一个broken_promise
+    ~promise() {
+        abandon();
+    }
+
+    future<T> get_future() {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        if (retrieved_)
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        retrieved_ = true;
+        state_->add_ref();
+        return future<T>(state_);
+    }
+
+    // 值的构造抛异常时promise仍未满足，异常传给调用方，之后还可以再set_value或set_exception
+    template <typename... Args>
+    void set_value(Args &&...args) {
+        check();
+        state_->emplace_value(std::forward<Args>(args)...);
+        satisfied_ = true;
+        state_->publish();
+    }
+
+    void set_exception(std::exception_ptr e) {
+        check();
+        satisfied_ = true;
+        state_->set_exception(std::move(e));
+    }
+
+  private:
+    void check() const {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        if (satisfied_)
+            throw std::future_error(std::future_errc::promise_already_satisfied);
+    }
+
+    void abandon() noexcept {
+        if (!state_)
+            return;
+        if (!satisfied_)
+            state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        std::exchange(state_, nullptr)->release();
+    }
+
+    detail::shared_state<T> *state_;
+    bool satisfied_ = false;
+    bool retrieved_ = false;
+};
+
+template <typename T>
+future<std::decay_t<T>> make_ready_future(T &&v) {
+    auto *s = new detail::shared_state<std::decay_t<T>>(1);
+    s->set_value(std::forward<T>(v));
+    return detail::access::make(s);
+}
+
+inline future<void> make_ready_future() {
+    auto *s = new detail::shared_state<void>(1);
+    s->set_value();
+    return detail::access::make(s);
+}
+
+// 全部就绪后得到所有结果，按输入顺序排列；任何一个出错则结果为第一个异常
+template <typename T>
+auto when_all(std::vector<future<T>> fs) -> future<std::vector<detail::non_void_t<T>>> {
+    using V = detail::non_void_t<T>;
+    struct context {
+        std::atomic<std::size_t> left;
+        std::vector<std::optional<V>> values;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        detail::shared_state<std::vector<V>> *out;
+
+        // 最后一个完成的子任务写结果并释放context
+        void finish() {
+            if (left.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            if (error) {
+                out->set_exception(error);
+            } else {
+                std::vector<V> r;
+                r.reserve(values.size());
+                for (auto &v : values)
+                    r.push_back(std::move(*v));
+                out->set_value(std::move(r));
+            }
+            out->release();
+            delete this;
+        }
+    };
+
+    auto *out = new detail::shared_state<std::vector<V>>(2);
+    auto result = detail::access::make(out);
+    if (fs.empty()) {
+        out->set_value();
+        out->release();
+        return result;
+    }
+    auto *ctx = new context{{fs.size()}, std::vector<std::optional<V>>(fs.size()), {false}, nullptr, out};
+    for (std::size_t i = 0; i < fs.size(); ++i) {
+        detail::access::release(fs[i])->set_callback([ctx, i](detail::shared_state<T> &s) {
+            auto o = s.take();
+            if (o.error) {
+                if (!ctx->failed.exchange(true, std::memory_order_relaxed))
+                    ctx->error = std::move(o.error);
+            } else {
+                ctx->values[i] = std::move(o.value);
+            }
+            ctx->finish();
+        });
+    }
+    return result;
+}
+
+// 可变参数版本，结果是tuple，void对应std::monostate
+template <typename... Ts>
+auto when_all(future<Ts>... fs) -> future<std::tuple<detail::non_void_t<Ts>...>> {
+    using tuple_t = std::tuple<detail::non_void_t<Ts>...>;
+    struct context {
+        std::atomic<std::size_t> left{sizeof...(Ts)};
+        std::tuple<std::optional<detail::non_void_t<Ts>>...> values;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        detail::shared_state<tuple_t> *out;
+
+        void finish() {
+            if (left.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            if (error)
+                out->set_exception(error);
+            else
+                out->set_value(std::apply([](auto &...v) { return tuple_t(std::move(*v)...); }, values));
+            out->release();
+            delete this;
+        }
+    };
+
+    auto *out = new detail::shared_state<tuple_t>(2);
+    auto result = detail::access::make(out);
+    auto *ctx = new context;
+    ctx->out = out;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (detail::access::release(fs)->set_callback([ctx](auto &s) {
+            auto o = s.take();
+            if (o.error) {
+                if (!ctx->failed.exchange(true, std::memory_order_relaxed))
+                    ctx->error = std::move(o.error);
+            } else {
+                std::get<I>(ctx->values) = std::move(o.value);
+            }
+            ctx->finish();
+        }),
+         ...);
+    }(std::index_sequence_for<Ts...>{});
+    return result;
+}
+
+// 第一个就绪的结果(值或异常)，其余的结果被丢弃
+template <typename T>
+auto when_any(std::vector<future<T>> fs) -> future<when_any_result<detail::non_void_t<T>>> {
+    using R = when_any_result<detail::non_void_t<T>>;
+    struct context {
+        std::atomic<std::size_t> left;
+        std::atomic<bool> done{false};
+        detail::shared_state<R> *out;
+    };
+
+    auto *out = new detail::shared_state<R>(2);
+    auto result = detail::access::make(out);
+    if (fs.empty()) {
+        out->set_exception(std::make_exception_ptr(std::invalid_argument("when_any: no futures")));
+        out->release();
+        return result;
+    }
+    auto *ctx = new context{{fs.size()}, {false}, out};
+    for (std::size_t i = 0; i < fs.size(); ++i) {
+        detail::access::release(fs[i])->set_callback([ctx, i](detail::shared_state<T> &s) {
+            if (!ctx->done.exchange(true, std::memory_order_acq_rel)) {
+                auto o = s.take();
+                if (o.error)
+                    ctx->out->set_exception(std::move(o.error));
+                else
+                    ctx->out->set_value(R{i, std::move(*o.value)});
+                ctx->out->release();
+            }
+            // context要等所有子任务都回调过才能释放
+            if (ctx->left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete ctx;
+        });
+    }
+    return result;
+}
+
+} // namespace cf
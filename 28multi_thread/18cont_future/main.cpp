@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "../../common/count_new.hpp"
+#include "../05thread_pool/thread_pool.hpp"
+#include "cont_future.hpp"
+
+using namespace std::chrono_literals;
+
+long long leaf(int i) {
+    long long s = 0;
+    for (int k = 0; k < 100; ++k)
+        s += i ^ k;
+    return s;
+}
+
+// 扇入DAG：leaves个叶子，每fan_in个节点汇总成上一层的一个节点，直到只剩根
+// 1) std::async：每个节点一个线程，内部节点在get()上阻塞等待子节点
+long long dag_std_async(int leaves, int fan_in) {
+    std::vector<std::future<long long>> level;
+    for (int i = 0; i < leaves; ++i)
+        level.push_back(std::async(std::launch::async, leaf, i));
+    while (level.size() > 1) {
+        std::vector<std::future<long long>> next;
+        for (std::size_t i = 0; i < level.size(); i += fan_in) {
+            std::vector<std::future<long long>> group;
+            for (std::size_t j = i; j < std::min(level.size(), i + fan_in); ++j)
+                group.push_back(std::move(level[j]));
+            next.push_back(std::async(std::launch::async, [group = std::move(group)]() mutable {
+                long long s = 0;
+                for (auto &f : group)
+                    s += f.get();
+                return s;
+            }));
+        }
+        level = std::move(next);
+    }
+    return level[0].get();
+}
+
+// 2) 叶子投递到线程池，内部节点用when_all + then，没有线程阻塞
+long long dag_cont(thread_pool &pool, int leaves, int fan_in) {
+    std::vector<cf::future<long long>> level;
+    for (int i = 0; i < leaves; ++i)
+        level.push_back(cf::make_ready_future().then(pool, [i] { return leaf(i); }));
+    while (level.size() > 1) {
+        std::vector<cf::future<long long>> next;
+        for (std::size_t i = 0; i < level.size(); i += fan_in) {
+            std::vector<cf::future<long long>> group;
+            for (std::size_t j = i; j < std::min(level.size(), i + fan_in); ++j)
+                group.push_back(std::move(level[j]));
+            next.push_back(cf::when_all(std::move(group)).then([](std::vector<long long> v) {
+                long long s = 0;
+                for (auto x : v)
+                    s += x;
+                return s;
+            }));
+        }
+        level = std::move(next);
+    }
+    return level[0].get();
+}
+
+int main(int argc, char *argv[]) {
+    thread_pool pool(4);
+
+    // 1. 对应04async中promise/future的例子，不再阻塞读取，而是挂续体
+    {
+        cf::promise<int> p;
+        auto fut = p.get_future().then([](int v) { return v + 1; }).then([](int v) {
+            return "result: " + std::to_string(v);
+        });
+
+        std::jthread t([&] {
+            std::this_thread::sleep_for(100ms);
+            p.set_value(122);
+        });
+
+        // 链尾仍然可以阻塞读取
+        std::cout << fut.get() << "\n"; // result: 123
+    }
+
+    // 2. 续体投递到线程池；异常沿then链传递，中间的f不会被调用
+    {
+        auto fut = cf::make_ready_future(1)
+                       .then(pool, [](int v) -> int { throw std::runtime_error("boom " + std::to_string(v)); })
+                       .then(pool, [](int v) {
+                           std::cout << "never printed\n";
+                           return v;
+                       });
+        try {
+            fut.get();
+        } catch (const std::exception &e) {
+            std::cout << "caught: " << e.what() << "\n";
+        }
+
+        // promise没设置结果就析构，future得到broken_promise
+        cf::future<int> orphan;
+        {
+            cf::promise<int> p;
+            orphan = p.get_future();
+        }
+        try {
+            orphan.get();
+        } catch (const std::future_error &e) {
+            std::cout << "caught: " << e.what() << "\n";
+        }
+    }
+
+    // 3. when_all / when_any
+    {
+        std::vector<cf::future<int>> fs;
+        for (int i = 1; i <= 4; ++i)
+            fs.push_back(cf::make_ready_future().then(pool, [i] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10 * i));
+                return i * i;
+            }));
+        auto sum = cf::when_all(std::move(fs)).then([](std::vector<int> v) {
+            int s = 0;
+            for (auto x : v)
+                s += x;
+            return s;
+        });
+        std::cout << "when_all sum = " << sum.get() << "\n"; // 30
+
+        auto [a, b] = cf::when_all(cf::make_ready_future(std::string("x")), cf::make_ready_future(2.5)).get();
+        std::cout << "when_all tuple = " << a << ", " << b << "\n";
+
+        std::vector<cf::future<int>> racers;
+        for (int i = 0; i < 3; ++i)
+            racers.push_back(cf::make_ready_future().then(pool, [i] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50 * (3 - i)));
+                return i;
+            }));
+        auto first = cf::when_any(std::move(racers)).get();
+        std::cout << "when_any index = " << first.index << ", value = " << first.value << "\n"; // 2, 2
+    }
+
+    // 4. 共享状态的分配：预热之后一条then链不再调用operator new
+    {
+        auto chain = [] {
+            return cf::make_ready_future(1).then([](int v) { return v + 1; }).then([](int v) { return v * 2; }).get();
+        };
+        chain();
+        auto before = new_calls.load();
+        long long s = 0;
+        for (int i = 0; i < 1000; ++i)
+            s += chain();
+        std::cout << "1000 chains: result " << s << ", operator new calls " << new_calls.load() - before << "\n";
+    }
+
+    // 5. 性能对比：约1万个节点的扇入DAG
+    {
+        int leaves = argc > 1 ? std::atoi(argv[1]) : 7500;
+        int fan_in = 4;
+        int nodes = 0;
+        for (int n = leaves; n > 1; n = (n + fan_in - 1) / fan_in)
+            nodes += n;
+        ++nodes;
+
+        long long expect = 0;
+        for (int i = 0; i < leaves; ++i)
+            expect += leaf(i);
+
+        long long r1 = 0, r2 = 0;
+        auto t1 = time_ms([&] { r1 = dag_std_async(leaves, fan_in); });
+        auto t2 = time_ms([&] { r2 = dag_cont(pool, leaves, fan_in); });
+        std::cout << nodes << " nodes, fan-in " << fan_in << "\n";
+        std::cout << "std::async + get:       " << t1 << " ms" << (r1 == expect ? "" : " WRONG") << "\n";
+        std::cout << "cf::when_all + then:    " << t2 << " ms" << (r2 == expect ? "" : " WRONG") << "\n";
+    }
+    return 0;
+}
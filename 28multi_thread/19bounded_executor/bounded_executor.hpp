@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../13mpmc_queue/mpmc_queue.hpp"
+#include "../18cont_future/cont_future.hpp"
+
+// 固定线程数、有界队列的执行器，以及std::async风格的async_on
+// std::async默认策略下libstdc++每次调用都新建一个线程，调用多了线程数和内存都不受控制
+// 1) 线程数在构造时固定，任务进入13mpmc_queue的有界队列
+// 2) 队列满时的行为可配置：阻塞提交者(反压)，或者由提交者自己执行(caller_runs)
+// 3) 取消沿用jthread/05thread_pool的模型：第一个参数是std::stop_token的任务拿到执行器的token
+// 4) async_on返回18cont_future的cf::future，可以继续then/when_all
+class bounded_executor {
+    using task = std::move_only_function<void()>;
+
+  public:
+    enum class when_full { block, caller_runs };
+
+    // 队列容量向上取整到2的幂
+    explicit bounded_executor(unsigned workers, std::size_t queue_capacity = 1024, when_full policy = when_full::block)
+        : queue_(std::bit_ceil(std::max<std::size_t>(queue_capacity, 2))), policy_(policy) {
+        threads_.reserve(workers);
+        for (unsigned i = 0; i < workers; ++i)
+            threads_.emplace_back([this] { run_worker(); });
+    }
+
+    bounded_executor(const bounded_executor &) = delete;
+    bounded_executor &operator=(const bounded_executor &) = delete;
+
+    // 先request_stop，再给每个worker发一个空任务作为退出信号
+    // 排在退出信号前面的任务仍然会执行(拿到的是已停止的token)
+    ~bounded_executor() {
+        stop_.request_stop();
+        for (std::size_t i = 0; i < threads_.size(); ++i)
+            queue_.push(task());
+        threads_.clear();
+    }
+
+    // 空任务是worker的退出信号，提交空任务(空的move_only_function、空函数指针等)抛出std::invalid_argument
+    template <typename F>
+    void post(F &&f) {
+        task t(std::forward<F>(f));
+        if (!t)
+            throw std::invalid_argument("bounded_executor: empty task");
+        if (policy_ == when_full::caller_runs) {
+            // try_emplace只在抢到槽位后才移动t，失败时t仍然完整
+            if (!queue_.try_emplace(std::move(t)))
+                t();
+        } else {
+            queue_.emplace(std::move(t));
+        }
+    }
+
+    std::stop_token get_stop_token() const noexcept {
+        return stop_.get_token();
+    }
+
+    bool request_stop() noexcept {
+        return stop_.request_stop();
+    }
+
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(threads_.size());
+    }
+
+    std::size_t capacity() const noexcept {
+        return queue_.capacity();
+    }
+
+  private:
+    void run_worker() {
+        for (;;) {
+            auto t = queue_.pop();
+            if (!t)
+                return;
+            t();
+        }
+    }
+
+    mpmc_queue<task> queue_;
+    when_full policy_;
+    std::stop_source stop_;
+    std::vector<std::jthread> threads_;
+};
+
+namespace detail {
+template <typename E>
+concept has_stop_token = requires(const E &e) {
+    { e.get_stop_token() } -> std::convertible_to<std::stop_token>;
+};
+
+template <typename E, typename F, typename... Args>
+constexpr bool async_takes_stop_token_v =
+    has_stop_token<E> && std::is_invocable_v<std::decay_t<F>, std::stop_token, std::decay_t<Args>...>;
+
+template <bool WithToken, typename F, typename... Args>
+struct async_result {
+    using type = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+};
+
+template <typename F, typename... Args>
+struct async_result<true, F, Args...> {
+    using type = std::invoke_result_t<std::decay_t<F>, std::stop_token, std::decay_t<Args>...>;
+};
+} // namespace detail
+
+// 在执行器ex上调用f(args...)，和std::thread一样对参数退化拷贝，需要引用请使用std::ref
+// f的第一个参数是std::stop_token并且执行器提供get_stop_token()时，传入执行器的token
+template <cf::executor E, typename F, typename... Args>
+auto async_on(E &ex, F &&f, Args &&...args) {
+    constexpr bool with_token = detail::async_takes_stop_token_v<E, F, Args...>;
+    using R = typename detail::async_result<with_token, F, Args...>::type;
+
+    cf::promise<R> p;
+    auto fut = p.get_future();
+    ex.post([&ex, p = std::move(p), f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable {
+        try {
+            auto call = [&]() -> R {
+                if constexpr (with_token)
+                    return std::invoke(std::move(f), ex.get_stop_token(), std::move(args)...);
+                else
+                    return std::invoke(std::move(f), std::move(args)...);
+            };
+            if constexpr (std::is_void_v<R>) {
+                call();
+                p.set_value();
+            } else {
+                p.set_value(call());
+            }
+        } catch (...) {
+            p.set_exception(std::current_exception());
+        }
+    });
+    return fut;
+}
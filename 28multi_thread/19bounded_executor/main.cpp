@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "bounded_executor.hpp"
+
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+// 从提交到开始执行的延迟
+void report_latency(std::vector<double> &lat, double total_ms) {
+    std::sort(lat.begin(), lat.end());
+    double sum = 0;
+    for (auto x : lat)
+        sum += x;
+    std::cout << "  total " << total_ms << " ms, start latency avg " << sum / lat.size() << " us, p50 "
+              << lat[lat.size() / 2] << " us, p99 " << lat[lat.size() * 99 / 100] << " us\n";
+}
+
+double since_us(clock_type::time_point t) {
+    return std::chrono::duration<double, std::micro>(clock_type::now() - t).count();
+}
+
+int main(int argc, char *argv[]) {
+    // 1. 替换04async中的std::async
+    {
+        bounded_executor ex(2, 64);
+        auto fut = async_on(ex, [] { return 42; });
+        std::cout << fut.get() << "\n"; // 42
+
+        // 参数退化拷贝，返回的cf::future可以继续挂续体
+        auto twice = async_on(ex, [](int a, int b) { return a + b; }, 20, 1).then([](int v) { return v * 2; });
+        std::cout << twice.get() << "\n"; // 42
+    }
+
+    // 2. 04async中的packaged_task<int(std::stop_token)>放到执行器上执行
+    // 执行器把自己的stop_token传进来，ex.request_stop()就能让任务退出
+    {
+        bounded_executor ex(1);
+        std::packaged_task<int(std::stop_token)> task([](std::stop_token st) {
+            while (!st.stop_requested())
+                std::this_thread::sleep_for(10ms);
+            return 10;
+        });
+        std::future<int> fut = task.get_future();
+        async_on(ex, std::move(task));
+        std::this_thread::sleep_for(100ms);
+        ex.request_stop();
+        std::cout << fut.get() << "\n"; // 10
+    }
+
+    // 3. 队列满时由提交者自己执行，调用方自然被减速
+    {
+        bounded_executor ex(1, 2, bounded_executor::when_full::caller_runs);
+        std::atomic<int> in_caller{0};
+        auto caller = std::this_thread::get_id();
+        std::vector<cf::future<void>> fs;
+        for (int i = 0; i < 16; ++i) {
+            fs.push_back(async_on(ex, [&] {
+                std::this_thread::sleep_for(5ms);
+                if (std::this_thread::get_id() == caller)
+                    ++in_caller;
+            }));
+        }
+        cf::when_all(std::move(fs)).get();
+        std::cout << "caller_runs: " << in_caller << " of 16 ran in caller\n";
+        // 空任务是worker的退出信号，post直接拒绝
+        try {
+            ex.post(static_cast<void (*)()>(nullptr));
+        } catch (const std::invalid_argument &e) {
+            std::cout << e.what() << "\n";
+        }
+    }
+
+    // 4. 性能对比：连续发起n次异步调用再全部get
+    {
+        int n = argc > 1 ? std::atoi(argv[1]) : 100'000;
+        std::vector<double> lat(n);
+
+        // 先测执行器，std::async退出后释放的内存会留在进程里，影响后测的rss
+        unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "async_on(bounded_executor(" << workers << ", 1024)) x " << n << "\n";
+        {
+            status_sampler sampler(1ms);
+            bounded_executor ex(workers, 1024);
+            auto ms = time_ms([&] {
+                std::vector<cf::future<int>> fs;
+                fs.reserve(n);
+                for (int i = 0; i < n; ++i)
+                    fs.push_back(async_on(ex, [&lat, i, t = clock_type::now()] {
+                        lat[i] = since_us(t);
+                        return i;
+                    }));
+                for (auto &f : fs)
+                    f.get();
+            });
+            sampler.report();
+            report_latency(lat, ms);
+        }
+
+        std::cout << "std::async x " << n << "\n";
+        {
+            status_sampler sampler(1ms);
+            auto ms = time_ms([&] {
+                std::vector<std::future<int>> fs;
+                fs.reserve(n);
+                for (int i = 0; i < n; ++i)
+                    fs.push_back(std::async([&lat, i, t = clock_type::now()] {
+                        lat[i] = since_us(t);
+                        return i;
+                    }));
+                for (auto &f : fs)
+                    f.get();
+            });
+            sampler.report();
+            report_latency(lat, ms);
+        }
+    }
+    return 0;
+}
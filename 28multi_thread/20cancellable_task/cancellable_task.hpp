@@ -0,0 +1,227 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "../06stop_wait/stop_wait.hpp"
+
+// 可取消的packaged_task
+// 04async里的packaged_task<int(std::stop_token)>只能在循环里轮询stop_requested()，而且future只有值和异常两种结果
+// 1) 任务函数第一个参数是std::stop_token，等待时用06stop_wait的wait_for_stop/sleep_for
+//    或condition_variable_any的stop_token重载挂起，取消时立即醒来，空闲时不占CPU
+// 2) future除了值和异常，还有"已取消"这个单独的状态：get()抛出task_cancelled，status()返回cancelled
+// 3) 还没开始执行就被取消的任务，future立即变为cancelled；执行器之后取到它时直接丢弃，函数不会被调用
+// 4) 构造时可以挂到外部的stop_token上，外部request_stop()一次取消一批任务
+// 状态只会按 pending -> running -> ready/cancelled 或 pending -> cancelled 变化，都用CAS完成
+
+class task_cancelled : public std::exception {
+  public:
+    const char *what() const noexcept override {
+        return "task cancelled";
+    }
+};
+
+// 任务函数里检查到取消后可以调用它，future会进入cancelled状态而不是普通异常
+inline void throw_if_cancelled(const std::stop_token &st) {
+    if (st.stop_requested())
+        throw task_cancelled();
+}
+
+enum class task_status : std::uint32_t { pending, running, ready, cancelled };
+
+template <typename R>
+class cancellable_future;
+
+namespace detail {
+template <typename R>
+struct cancellable_state {
+    std::atomic<task_status> status{task_status::pending};
+    std::stop_source stop;
+    std::optional<std::conditional_t<std::is_void_v<R>, std::monostate, R>> value;
+    std::exception_ptr error;
+
+    void finish(task_status s) {
+        status.store(s, std::memory_order_release);
+        status.notify_all();
+    }
+
+    // 还没开始时直接转为cancelled，已经在执行时只发停止请求，由任务自己决定怎么结束
+    bool cancel() {
+        stop.request_stop();
+        auto expected = task_status::pending;
+        if (status.compare_exchange_strong(expected, task_status::cancelled, std::memory_order_acq_rel)) {
+            status.notify_all();
+            return true;
+        }
+        return false;
+    }
+
+    task_status wait() const {
+        auto s = status.load(std::memory_order_acquire);
+        while (s == task_status::pending || s == task_status::running) {
+            status.wait(s, std::memory_order_acquire);
+            s = status.load(std::memory_order_acquire);
+        }
+        return s;
+    }
+};
+} // namespace detail
+
+template <typename R>
+class cancellable_future {
+    template <typename>
+    friend class cancellable_task;
+
+    explicit cancellable_future(std::shared_ptr<detail::cancellable_state<R>> s) : state_(std::move(s)) {
+    }
+
+  public:
+    cancellable_future() = default;
+
+    bool valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    task_status status() const noexcept {
+        return state_->status.load(std::memory_order_acquire);
+    }
+
+    bool is_cancelled() const noexcept {
+        return status() == task_status::cancelled;
+    }
+
+    // 请求取消，返回true表示任务还没开始，已经确定不会执行
+    bool cancel() {
+        return state_->cancel();
+    }
+
+    void wait() const {
+        state_->wait();
+    }
+
+    R get() {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        auto s = std::exchange(state_, nullptr);
+        if (s->wait() == task_status::cancelled)
+            throw task_cancelled();
+        if (s->error)
+            std::rethrow_exception(s->error);
+        if constexpr (!std::is_void_v<R>)
+            return std::move(*s->value);
+    }
+
+  private:
+    std::shared_ptr<detail::cancellable_state<R>> state_;
+};
+
+template <typename>
+class cancellable_task;
+
+template <typename R, typename... Args>
+class cancellable_task<R(Args...)> {
+    using state = detail::cancellable_state<R>;
+
+    struct canceller {
+        std::shared_ptr<state> s;
+        void operator()() const {
+            s->cancel();
+        }
+    };
+
+  public:
+    cancellable_task() = default;
+
+    // f可以接受(std::stop_token, Args...)或者(Args...)
+    // outer不为空时，outer上的停止请求会取消这个任务
+    template <typename F>
+        requires(!std::is_same_v<std::decay_t<F>, cancellable_task>)
+    explicit cancellable_task(F &&f, std::stop_token outer = {}) : state_(std::make_shared<state>()) {
+        if constexpr (std::is_invocable_r_v<R, std::decay_t<F> &, std::stop_token, Args...>)
+            fn_ = std::forward<F>(f);
+        else
+            fn_ = [f = std::forward<F>(f)](std::stop_token, Args... args) mutable -> R {
+                return std::invoke(f, std::forward<Args>(args)...);
+            };
+        if (outer.stop_possible())
+            link_ = std::make_unique<std::stop_callback<canceller>>(std::move(outer), canceller{state_});
+    }
+
+    cancellable_task(cancellable_task &&) noexcept = default;
+
+    cancellable_task &operator=(cancellable_task &&other) noexcept {
+        if (this != &other) {
+            abandon();
+            link_ = std::move(other.link_);
+            fn_ = std::move(other.fn_);
+            state_ = std::move(other.state_);
+        }
+        return *this;
+    }
+
+    // 没执行就被销毁(比如执行器析构时丢弃了队列)，future按取消处理，不会永远等下去
+    ~cancellable_task() {
+        abandon();
+    }
+
+    bool valid() const noexcept {
+        return state_ != nullptr;
+    }
+
+    cancellable_future<R> get_future() const {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+        return cancellable_future<R>(state_);
+    }
+
+    bool cancel() {
+        return state_->cancel();
+    }
+
+    bool is_cancelled() const noexcept {
+        return state_->status.load(std::memory_order_acquire) == task_status::cancelled;
+    }
+
+    // 只有从pending抢到running才会调用函数，已取消的任务直接释放函数对象后返回
+    void operator()(Args... args) {
+        auto expected = task_status::pending;
+        if (!state_->status.compare_exchange_strong(expected, task_status::running, std::memory_order_acq_rel)) {
+            fn_ = nullptr;
+            return;
+        }
+        try {
+            if constexpr (std::is_void_v<R>) {
+                fn_(state_->stop.get_token(), std::forward<Args>(args)...);
+                state_->value.emplace();
+            } else {
+                state_->value.emplace(fn_(state_->stop.get_token(), std::forward<Args>(args)...));
+            }
+            state_->finish(task_status::ready);
+        } catch (const task_cancelled &) {
+            state_->finish(task_status::cancelled);
+        } catch (...) {
+            state_->error = std::current_exception();
+            state_->finish(task_status::ready);
+        }
+        fn_ = nullptr;
+    }
+
+  private:
+    void abandon() noexcept {
+        link_.reset();
+        if (state_)
+            state_->cancel();
+    }
+
+    std::shared_ptr<state> state_;
+    std::move_only_function<R(std::stop_token, Args...)> fn_;
+    std::unique_ptr<std::stop_callback<canceller>> link_;
+};
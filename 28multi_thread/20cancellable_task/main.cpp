@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "../19bounded_executor/bounded_executor.hpp"
+#include "cancellable_task.hpp"
+
+using namespace std::chrono_literals;
+
+const char *status_name(task_status s) {
+    switch (s) {
+    case task_status::pending:
+        return "pending";
+    case task_status::running:
+        return "running";
+    case task_status::ready:
+        return "ready";
+    case task_status::cancelled:
+        return "cancelled";
+    }
+    return "?";
+}
+
+// 三种等待取消的写法，任务体以外完全相同
+// 1) 04async的写法：空转检查stop_requested
+int wait_spin(std::stop_token st) {
+    while (!st.stop_requested()) {
+    }
+    return 10;
+}
+
+// 2) 轮询：每1ms醒来检查一次
+int wait_poll(std::stop_token st) {
+    while (!st.stop_requested())
+        std::this_thread::sleep_for(1ms);
+    return 10;
+}
+
+// 3) 挂起：由stop_callback唤醒
+int wait_park(std::stop_token st) {
+    wait_for_stop(st);
+    return 10;
+}
+
+struct idle_result {
+    double cpu_ms;    // 空闲期间进程消耗的CPU时间
+    double cancel_us; // 从cancel()到future就绪的平均延迟
+};
+
+idle_result bench(int (*body)(std::stop_token), std::chrono::milliseconds idle, int rounds) {
+    idle_result r{0, 0};
+    for (int i = 0; i < rounds; ++i) {
+        cancellable_task<int()> task(body);
+        auto fut = task.get_future();
+        std::jthread t(std::move(task));
+        auto c0 = std::clock();
+        std::this_thread::sleep_for(idle);
+        auto c1 = std::clock();
+        auto t0 = std::chrono::steady_clock::now();
+        fut.cancel();
+        fut.wait();
+        auto t1 = std::chrono::steady_clock::now();
+        r.cpu_ms += 1000.0 * (c1 - c0) / CLOCKS_PER_SEC;
+        r.cancel_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    }
+    r.cpu_ms /= rounds;
+    r.cancel_us /= rounds;
+    return r;
+}
+
+int main(void) {
+    // 1. 04async中的packaged_task<int(std::stop_token)>：不再空转打印，而是挂起等待
+    {
+        cancellable_task<int()> task([](std::stop_token st) {
+            std::cout << "wait for stop\n";
+            wait_for_stop(st);
+            return 10;
+        });
+        auto fut = task.get_future();
+        std::jthread t(std::move(task));
+        std::this_thread::sleep_for(100ms);
+        fut.cancel();
+        fut.wait();
+        // 任务观察到取消后仍然正常返回，结果是值
+        std::cout << status_name(fut.status()) << " " << fut.get() << "\n"; // ready 10
+    }
+
+    // 2. 挂起等待"有活干或者被取消"，被取消时以cancelled结束
+    {
+        std::mutex m;
+        std::condition_variable_any cv;
+        std::deque<int> work;
+        cancellable_task<int()> consumer([&](std::stop_token st) {
+            int sum = 0;
+            for (;;) {
+                std::unique_lock lk(m);
+                // stop_token重载：有新任务或者取消都会醒来
+                cv.wait(lk, st, [&] { return !work.empty(); });
+                throw_if_cancelled(st);
+                sum += work.front();
+                work.pop_front();
+                std::cout << "consumed, sum = " << sum << "\n";
+            }
+            return sum;
+        });
+        auto fut = consumer.get_future();
+        std::jthread t(std::move(consumer));
+        for (int i = 1; i <= 3; ++i) {
+            {
+                std::lock_guard lg(m);
+                work.push_back(i);
+            }
+            cv.notify_one();
+            std::this_thread::sleep_for(20ms);
+        }
+        fut.cancel();
+        fut.wait();
+        std::cout << "consumer " << status_name(fut.status()) << "\n"; // cancelled
+        try {
+            fut.get();
+        } catch (const task_cancelled &e) {
+            std::cout << "get(): " << e.what() << "\n";
+        }
+    }
+
+    // 3. 执行器丢弃已排队但还没开始的任务
+    {
+        bounded_executor ex(1, 2048);
+        std::stop_source batch;
+        std::atomic<int> ran{0};
+
+        // 先占住唯一的worker
+        std::atomic<bool> release{false};
+        ex.post([&] {
+            while (!release.load())
+                std::this_thread::sleep_for(1ms);
+        });
+
+        std::vector<cancellable_future<void>> fs;
+        for (int i = 0; i < 1000; ++i) {
+            cancellable_task<void()> task([&] { ++ran; }, batch.get_token());
+            fs.push_back(task.get_future());
+            ex.post(std::move(task));
+        }
+        // 一次取消整批，future立即就绪，不需要等worker取到它们
+        batch.request_stop();
+        int cancelled = 0;
+        for (auto &f : fs)
+            cancelled += f.is_cancelled();
+        release = true;
+        std::cout << "cancelled " << cancelled << " of 1000 before any ran\n";
+        std::cout << "bodies executed: " << ran << "\n"; // 0
+    }
+
+    // 4. 空闲时的CPU占用和取消延迟
+    {
+        const auto idle = 200ms;
+        const int rounds = 5;
+        auto report = [&](const char *name, idle_result r) {
+            std::cout << name << "cpu " << r.cpu_ms << " ms per " << idle.count() << " ms idle, cancel latency "
+                      << r.cancel_us << " us\n";
+        };
+        report("spin:  ", bench(wait_spin, idle, rounds));
+        report("poll:  ", bench(wait_poll, idle, rounds));
+        report("park:  ", bench(wait_park, idle, rounds));
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <latch>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "scheduler.hpp"
+
+using namespace std::chrono_literals;
+
+// 唤醒时间比截止时间晚了多少
+void report_lateness(std::vector<double> &late, double total_ms) {
+    if (late.empty()) {
+        std::cout << "  total " << total_ms << " ms, no wakeups recorded\n";
+        return;
+    }
+    std::sort(late.begin(), late.end());
+    double sum = 0;
+    for (auto x : late)
+        sum += x;
+    std::cout << "  total " << total_ms << " ms, wakeup lateness avg " << sum / late.size() << " us, p50 "
+              << late[late.size() / 2] << " us, p99 " << late[late.size() * 99 / 100] << " us, max " << late.back()
+              << " us\n";
+}
+
+// 1. 对应上一级main.cpp里的Awaiter：挂起500ms，但不占住线程
+coro::detached foo(coro::run_loop &loop, int id) {
+    co_await loop.schedule();
+    std::cout << "Suspend " << id << "\n";
+    co_await coro::sleep_for(500ms);
+    std::cout << "result = " << id << "\n";
+}
+
+// 2. 在多线程调度器上执行
+coro::detached hop(coro::scheduler &s, int id, std::latch &done) {
+    co_await s.schedule();
+    for (int i = 0; i < 3; ++i) {
+        co_await coro::sleep_for(10ms);
+        co_await s.schedule();
+    }
+    std::cout << "coroutine " + std::to_string(id) + " finished\n";
+    done.count_down();
+}
+
+coro::detached sleeper(coro::run_loop &loop, std::chrono::milliseconds d, double &late) {
+    co_await loop.schedule();
+    auto deadline = coro::clock::now() + d;
+    co_await coro::sleep_until(deadline);
+    late = std::chrono::duration<double, std::micro>(coro::clock::now() - deadline).count();
+}
+
+int main(int argc, char *argv[]) {
+    {
+        coro::run_loop loop;
+        foo(loop, 1);
+        foo(loop, 2);
+        auto beg = coro::clock::now();
+        // 两个协程在同一个线程上同时睡眠，总共只需要500ms
+        loop.run();
+        std::cout << "run_loop took "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(coro::clock::now() - beg).count() << " ms\n";
+    }
+
+    {
+        coro::scheduler s(2);
+        std::latch done(4);
+        for (int i = 0; i < 4; ++i)
+            hop(s, i, done);
+        done.wait();
+    }
+
+    // 3. 性能对比：n个同时睡眠的协程和n个睡眠的线程
+    // 睡眠时间在200ms到1s之间错开
+    {
+        std::size_t n = argc > 1 ? std::atoi(argv[1]) : 100'000;
+        std::vector<double> late(n);
+        auto duration = [](std::size_t i) { return std::chrono::milliseconds(200 + i % 800); };
+
+        std::cout << n << " coroutines on one run_loop thread\n";
+        {
+            status_sampler sampler;
+            auto beg = coro::clock::now();
+            coro::run_loop loop;
+            for (std::size_t i = 0; i < n; ++i)
+                sleeper(loop, duration(i), late[i]);
+            loop.run();
+            auto ms = std::chrono::duration<double, std::milli>(coro::clock::now() - beg).count();
+            sampler.report(n);
+            report_lateness(late, ms);
+        }
+
+        // 线程数受系统限制(threads-max、max_map_count、ulimit -u)，创建失败时就停下，只统计已创建的
+        std::cout << n << " threads\n";
+        {
+            std::vector<double> tlate(n);
+            std::size_t created = 0;
+            status_sampler sampler;
+            auto beg = coro::clock::now();
+            {
+                std::vector<std::jthread> ts;
+                ts.reserve(n);
+                try {
+                    for (; created < n; ++created) {
+                        ts.emplace_back([&tlate, i = created, d = duration(created)] {
+                            auto deadline = coro::clock::now() + d;
+                            std::this_thread::sleep_until(deadline);
+                            tlate[i] = std::chrono::duration<double, std::micro>(coro::clock::now() - deadline).count();
+                        });
+                    }
+                } catch (const std::system_error &e) {
+                    std::cout << "  thread creation failed after " << created << " threads: " << e.what() << "\n";
+                }
+            }
+            auto ms = std::chrono::duration<double, std::milli>(coro::clock::now() - beg).count();
+            sampler.report(created);
+            tlate.resize(created);
+            report_lateness(tlate, ms);
+        }
+    }
+    return 0;
+}
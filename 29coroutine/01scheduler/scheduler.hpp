@@ -0,0 +1,386 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 协程调度器
+// 上一级main.cpp里的Awaiter在await_suspend中sleep_for(500ms)后直接h.resume()，挂起期间线程被占住，
+// 协程和普通函数调用没有区别。这里把"恢复"交给调度器：
+// 1) await_suspend只把句柄放进就绪队列(或定时器)就返回，线程回到调度循环去执行别的协程
+// 2) run_loop：单线程，在调用run()的线程上执行，队列和定时器都空时返回
+// 3) scheduler：固定数量的工作线程共享一个就绪队列
+// 4) 定时器用时间轮，节点就放在挂起协程的awaiter里，co_await sleep_for(d)不分配内存、不占线程
+// 5) 同一时刻只有一个空闲线程负责时间轮，睡到最早的截止时间；插入更早的定时器时叫醒它，其余空闲线程无限期等待
+// 6) defer登记的动作在当前线程取空就绪队列时(或每执行drain_batch个协程)执行一次，io_context用它批量提交I/O
+namespace coro {
+
+using clock = std::chrono::steady_clock;
+
+// 挂在时间轮上的节点，生命周期和co_await表达式里的awaiter相同
+struct timer_node {
+    timer_node *next = nullptr;
+    clock::time_point deadline;
+    std::coroutine_handle<> handle;
+};
+
+// 单层哈希时间轮，不是线程安全的，由调度器加锁保护
+// 到期时间按tick取整后放到 tick % slots 号槽里，超过一圈的节点留在槽里等下一圈
+// 推进时只检查经过的槽，插入和到期都是O(1)，和当前睡眠的协程数量无关
+class timer_wheel {
+  public:
+    static constexpr std::size_t slots = 1024;
+    static constexpr clock::duration tick = std::chrono::milliseconds(1);
+
+    explicit timer_wheel(clock::time_point start = clock::now()) : start_(start), buckets_(slots) {
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    void add(timer_node *n) noexcept {
+        auto t = std::max(ticks(n->deadline), current_);
+        auto &head = buckets_[t % slots];
+        n->next = head;
+        head = n;
+        ++size_;
+    }
+
+    // 把截止时间不晚于now的节点交给on_expire，返回到期的个数
+    template <typename F>
+    std::size_t advance(clock::time_point now, F &&on_expire) {
+        auto target = ticks(now);
+        if (target < current_)
+            return 0;
+        std::size_t expired = 0;
+        // 跨度超过一圈时每个槽只需要看一遍
+        auto steps = std::min<std::uint64_t>(target - current_ + 1, slots);
+        for (std::uint64_t i = 0; i < steps; ++i) {
+            auto **link = &buckets_[(current_ + i) % slots];
+            while (auto *n = *link) {
+                if (n->deadline <= now) {
+                    *link = n->next;
+                    --size_;
+                    ++expired;
+                    on_expire(n);
+                } else {
+                    link = &n->next;
+                }
+            }
+        }
+        // deadline在当前tick内但还没到的节点留在current_号槽里，下次推进时会再看一遍
+        current_ = target;
+        return expired;
+    }
+
+    // 最早的截止时间，调用前时间轮不能为空
+    // 从current_号槽往后找第一个有本圈节点的槽；一圈之内都没有时，所有节点都在以后的圈里，整个扫一遍
+    clock::time_point next_deadline() const noexcept {
+        auto best = clock::time_point::max();
+        for (std::uint64_t t = current_; t < current_ + slots; ++t) {
+            for (auto *n = buckets_[t % slots]; n; n = n->next)
+                if (ticks(n->deadline) <= t)
+                    best = std::min(best, n->deadline);
+            if (best != clock::time_point::max())
+                return best;
+        }
+        for (auto *head : buckets_)
+            for (auto *n = head; n; n = n->next)
+                best = std::min(best, n->deadline);
+        return best;
+    }
+
+  private:
+    std::uint64_t ticks(clock::time_point tp) const noexcept {
+        return tp <= start_ ? 0 : static_cast<std::uint64_t>((tp - start_) / tick);
+    }
+
+    clock::time_point start_;
+    std::uint64_t current_ = 0;
+    std::size_t size_ = 0;
+    std::vector<timer_node *> buckets_;
+};
+
+// run_loop和scheduler共用的部分：就绪队列 + 时间轮 + 条件变量
+class scheduler_core {
+  public:
+    scheduler_core() = default;
+    scheduler_core(const scheduler_core &) = delete;
+    scheduler_core &operator=(const scheduler_core &) = delete;
+
+    // 任何线程都可以调用
+    void post(std::coroutine_handle<> h) {
+        bool wake_owner;
+        {
+            std::lock_guard lg(m_);
+            ready_.push_back(h);
+            // 没有无限期等待的线程时，只能叫醒睡在时间轮上的那个(run_loop只有这一个线程)
+            wake_owner = idle_ == 0 && timer_owner_;
+        }
+        if (wake_owner)
+            timer_cv_.notify_one();
+        else
+            cv_.notify_one();
+    }
+
+    // 一次放入多个句柄，只加一次锁
+    void post(std::span<const std::coroutine_handle<>> hs) {
+        if (hs.empty())
+            return;
+        bool wake_owner;
+        {
+            std::lock_guard lg(m_);
+            ready_.insert(ready_.end(), hs.begin(), hs.end());
+            wake_owner = idle_ == 0 && timer_owner_;
+        }
+        if (wake_owner)
+            timer_cv_.notify_one();
+        else if (hs.size() == 1)
+            cv_.notify_one();
+        else
+            cv_.notify_all();
+    }
+
+    void add_timer(timer_node *n) {
+        enum { none, owner, idle } wake = none;
+        {
+            std::lock_guard lg(m_);
+            wheel_.add(n);
+            if (timer_owner_)
+                wake = n->deadline < timer_wake_ ? owner : none;
+            else if (idle_)
+                wake = idle;
+        }
+        // 比负责时间轮的线程预定的醒来时间更早，叫醒它重新计算；没有人负责时叫醒一个空闲线程来接手
+        if (wake == owner)
+            timer_cv_.notify_one();
+        else if (wake == idle)
+            cv_.notify_one();
+    }
+
+    void request_stop() {
+        {
+            std::lock_guard lg(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        timer_cv_.notify_all();
+    }
+
+    // 当前线程正在运行的调度器，sleep_for靠它找到时间轮
+    static scheduler_core *current() noexcept {
+        return current_;
+    }
+
+    // 只能在调度器线程上调用；同一个(fn, arg)在执行前重复登记只算一次
+    static void defer(void (*fn)(void *), void *arg) {
+        for (auto &d : deferred_)
+            if (d.fn == fn && d.arg == arg)
+                return;
+        deferred_.push_back({fn, arg});
+    }
+
+    static constexpr unsigned drain_batch = 64;
+
+  protected:
+    // until_idle为true时，队列和定时器都空了就返回，否则一直运行到request_stop
+    void run(bool until_idle) {
+        auto *prev = std::exchange(current_, this);
+        unsigned resumed = 0;
+        std::unique_lock lk(m_);
+        for (;;) {
+            if (!wheel_.empty()) {
+                auto n = wheel_.advance(clock::now(), [&](timer_node *t) { ready_.push_back(t->handle); });
+                if (n > 1)
+                    cv_.notify_all();
+            }
+            if (!ready_.empty()) {
+                auto h = ready_.front();
+                ready_.pop_front();
+                // 去执行协程之前，还有定时器却没有线程负责时，交给一个空闲线程
+                bool hand_off = !wheel_.empty() && !timer_owner_ && idle_;
+                lk.unlock();
+                if (hand_off)
+                    cv_.notify_one();
+                h.resume();
+                if (++resumed % drain_batch == 0)
+                    run_deferred();
+                lk.lock();
+                continue;
+            }
+            // 就绪队列空了，等待之前先执行登记的动作，它们可能又放入新的协程
+            if (!deferred_.empty()) {
+                lk.unlock();
+                run_deferred();
+                lk.lock();
+                continue;
+            }
+            if (stop_)
+                break;
+            if (!wheel_.empty() && !timer_owner_) {
+                timer_owner_ = true;
+                timer_wake_ = wheel_.next_deadline();
+                timer_cv_.wait_until(lk, timer_wake_);
+                timer_owner_ = false;
+            } else if (wheel_.empty() && until_idle) {
+                break;
+            } else {
+                ++idle_;
+                cv_.wait(lk);
+                --idle_;
+            }
+        }
+        lk.unlock();
+        run_deferred();
+        current_ = prev;
+    }
+
+  private:
+    struct deferred_action {
+        void (*fn)(void *);
+        void *arg;
+    };
+
+    static void run_deferred() {
+        // 执行过程中可能有新的登记，按下标遍历
+        for (std::size_t i = 0; i < deferred_.size(); ++i)
+            deferred_[i].fn(deferred_[i].arg);
+        deferred_.clear();
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;       // 空闲线程在这里无限期等待
+    std::condition_variable timer_cv_; // 负责时间轮的线程在这里等到timer_wake_
+    std::deque<std::coroutine_handle<>> ready_;
+    timer_wheel wheel_;
+    unsigned idle_ = 0;
+    bool timer_owner_ = false;
+    clock::time_point timer_wake_;
+    bool stop_ = false;
+
+    static inline thread_local scheduler_core *current_ = nullptr;
+    static inline thread_local std::vector<deferred_action> deferred_;
+};
+
+// 把协程转移到调度器上执行
+struct schedule_awaiter {
+    scheduler_core &core;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> h) {
+        core.post(h);
+    }
+    void await_resume() const noexcept {
+    }
+};
+
+// 单线程事件循环
+class run_loop : public scheduler_core {
+  public:
+    schedule_awaiter schedule() noexcept {
+        return {*this};
+    }
+
+    // 在当前线程上执行，直到没有就绪的协程也没有定时器
+    void run() {
+        scheduler_core::run(true);
+    }
+};
+
+// 多线程调度器
+class scheduler : public scheduler_core {
+  public:
+    explicit scheduler(unsigned n = std::max(1u, std::thread::hardware_concurrency())) {
+        threads_.reserve(n);
+        for (unsigned i = 0; i < n; ++i)
+            threads_.emplace_back([this] { scheduler_core::run(false); });
+    }
+
+    // 和jthread一样，析构时停止并join；还在睡眠的协程不会再被恢复
+    ~scheduler() {
+        request_stop();
+        threads_.clear();
+    }
+
+    schedule_awaiter schedule() noexcept {
+        return {*this};
+    }
+
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(threads_.size());
+    }
+
+  private:
+    std::vector<std::jthread> threads_;
+};
+
+// co_await sleep_until(tp)：把当前协程挂到所在调度器的时间轮上
+// 不在调度器线程上调用时退化为阻塞当前线程的睡眠
+struct sleep_awaiter {
+    timer_node node;
+
+    bool await_ready() const noexcept {
+        return node.deadline <= clock::now();
+    }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        auto *core = scheduler_core::current();
+        if (!core) {
+            std::this_thread::sleep_until(node.deadline);
+            return false;
+        }
+        node.handle = h;
+        core->add_timer(&node);
+        return true;
+    }
+
+    void await_resume() const noexcept {
+    }
+};
+
+inline sleep_awaiter sleep_until(clock::time_point tp) {
+    return {timer_node{nullptr, tp, {}}};
+}
+
+template <typename Rep, typename Period>
+sleep_awaiter sleep_for(std::chrono::duration<Rep, Period> d) {
+    return sleep_until(clock::now() + std::chrono::duration_cast<clock::duration>(d));
+}
+
+// 即发即弃的协程，创建后立即开始执行，结束时自动销毁
+struct detached {
+    struct promise_type {
+        detached get_return_object() noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+        void return_void() noexcept {
+        }
+    };
+};
+
+} // namespace coro
@@ -0,0 +1,193 @@
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "../../common/bench.hpp"
+#include "../01scheduler/scheduler.hpp"
+#include "task.hpp"
+
+using namespace std::chrono_literals;
+
+// 对照组：await_suspend和final_suspend里直接resume，每层co_await都要压两层栈
+template <typename T>
+class naive_task {
+  public:
+    struct promise_type {
+        T value{};
+        std::coroutine_handle<> continuation;
+
+        naive_task get_return_object() {
+            return naive_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        auto final_suspend() noexcept {
+            struct awaiter {
+                bool await_ready() noexcept {
+                    return false;
+                }
+                void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    if (auto c = h.promise().continuation)
+                        c.resume();
+                }
+                void await_resume() noexcept {
+                }
+            };
+            return awaiter{};
+        }
+        void return_value(T v) {
+            value = v;
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+    explicit naive_task(std::coroutine_handle<promise_type> h) : h_(h) {
+    }
+    naive_task(naive_task &&o) noexcept : h_(std::exchange(o.h_, nullptr)) {
+    }
+    ~naive_task() {
+        if (h_)
+            h_.destroy();
+    }
+
+    auto operator co_await() {
+        struct awaiter {
+            std::coroutine_handle<promise_type> h;
+            bool await_ready() {
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> caller) {
+                h.promise().continuation = caller;
+                h.resume();
+            }
+            T await_resume() {
+                return h.promise().value;
+            }
+        };
+        return awaiter{h_};
+    }
+
+    // 同步执行，resume返回时整条链已经执行完
+    T run() {
+        h_.resume();
+        return h_.promise().value;
+    }
+
+  private:
+    std::coroutine_handle<promise_type> h_;
+};
+
+// 1. 惰性：创建时不执行，co_await时才开始
+coro::task<int> answer() {
+    std::cout << "answer() running\n";
+    co_return 42;
+}
+
+coro::task<std::string> describe() {
+    auto t = answer();
+    std::cout << "answer() created\n";
+    int v = co_await t;
+    co_return "answer = " + std::to_string(v);
+}
+
+// 2. 异常沿co_await链传递
+coro::task<int> fail() {
+    throw std::runtime_error("boom");
+    co_return 0;
+}
+
+coro::task<> catch_it() {
+    try {
+        co_await fail();
+    } catch (const std::exception &e) {
+        std::cout << "caught: " << e.what() << "\n";
+    }
+}
+
+// 3. 和01scheduler配合：切到调度器的线程上睡眠，sync_wait在原线程上等
+coro::task<std::thread::id> on_scheduler(coro::scheduler &s) {
+    co_await s.schedule();
+    co_await coro::sleep_for(10ms);
+    co_return std::this_thread::get_id();
+}
+
+// 4. 深度递归
+static std::uintptr_t leaf_sp = 0;
+
+[[gnu::noinline]] std::uintptr_t stack_pointer() {
+    volatile char c = 0;
+    return reinterpret_cast<std::uintptr_t>(&c);
+}
+
+template <template <typename> class Task>
+Task<long> nested(int n) {
+    if (n == 0) {
+        leaf_sp = stack_pointer();
+        co_return 0;
+    }
+    co_return 1 + co_await nested<Task>(n - 1);
+}
+
+coro::task<long> one() {
+    co_return 1;
+}
+
+coro::task<long> flat(int n) {
+    long s = 0;
+    for (int i = 0; i < n; ++i)
+        s += co_await one();
+    co_return s;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << coro::sync_wait(describe()) << "\n";
+    coro::sync_wait(catch_it());
+    try {
+        coro::sync_wait(fail());
+    } catch (const std::exception &e) {
+        std::cout << "sync_wait rethrew: " << e.what() << "\n";
+    }
+    {
+        coro::scheduler s(1);
+        auto id = coro::sync_wait(on_scheduler(s));
+        std::cout << "ran on scheduler thread: " << (id != std::this_thread::get_id()) << "\n";
+    }
+
+    // 5. 性能：嵌套co_await的栈深度和每层的开销
+    // 注意对称转移依赖编译器把切换做成尾调用，-O0下gcc不会这样做，深递归仍可能栈溢出
+    {
+        int depth = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+        int naive_depth = 10'000;
+
+        // 每项先跑一遍预热，第一次运行包含栈和堆的缺页
+        coro::sync_wait(nested<coro::task>(depth));
+
+        auto top = stack_pointer();
+        long r = 0;
+        auto ms = time_ms([&] { r = coro::sync_wait(nested<coro::task>(depth)); });
+        std::cout << "task<T>:     depth " << r << ", stack used " << static_cast<long>(top - leaf_sp) << " B, "
+                  << ms * 1e6 / depth << " ns per level\n";
+
+        // 对照组每层都要占栈，默认8MB的栈在1M层时必然溢出，只测1万层
+        nested<naive_task>(naive_depth).run();
+        top = stack_pointer();
+        ms = time_ms([&] { r = nested<naive_task>(naive_depth).run(); });
+        std::cout << "naive_task:  depth " << r << ", stack used " << static_cast<long>(top - leaf_sp) << " B ("
+                  << static_cast<double>(top - leaf_sp) / naive_depth << " B per level), " << ms * 1e6 / naive_depth
+                  << " ns per level\n";
+
+        ms = time_ms([&] { r = coro::sync_wait(flat(depth)); });
+        std::cout << "flat loop:   " << r << " sequential co_awaits, " << ms * 1e6 / depth << " ns each\n";
+    }
+    return 0;
+}
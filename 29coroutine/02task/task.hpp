@@ -0,0 +1,254 @@
+#pragma once
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// 惰性、可等待的task<T>
+// 上一级main.cpp里的Task两处都是suspend_never，调用即执行，拿不到结果也没法co_await；
+// genreturn则要靠外部轮询handle_.done()。这里：
+// 1) initial_suspend返回suspend_always，创建后不执行，直到被co_await才开始
+// 2) co_await task时await_suspend返回被等待协程的句柄，直接切换过去(对称转移)
+// 3) 被等待的协程结束时final_suspend同样返回调用者的句柄切回去
+//    切换由编译器做成尾调用，嵌套多少层co_await栈深度都不变；await_suspend里直接h.resume()的话每层都会压栈
+// 4) 协程体抛出的异常由unhandled_exception保存，在调用方的co_await处重新抛出
+// 5) 普通函数里用sync_wait(task)启动并取得结果
+namespace coro {
+
+template <typename T = void>
+class task;
+
+namespace detail {
+
+// 结束时切回等待者，没有等待者时切到noop，回到resume()的调用处
+struct final_awaiter {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+        if (auto c = h.promise().continuation)
+            return c;
+        return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {
+    }
+};
+
+struct task_promise_base {
+    std::coroutine_handle<> continuation;
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    final_awaiter final_suspend() const noexcept {
+        return {};
+    }
+};
+
+template <typename T>
+struct task_promise : task_promise_base {
+    std::variant<std::monostate, T, std::exception_ptr> result;
+
+    task<T> get_return_object() noexcept;
+
+    template <typename U>
+        requires std::is_convertible_v<U &&, T>
+    void return_value(U &&v) {
+        result.template emplace<1>(std::forward<U>(v));
+    }
+
+    void unhandled_exception() noexcept {
+        result.template emplace<2>(std::current_exception());
+    }
+
+    T take() {
+        if (result.index() == 2)
+            std::rethrow_exception(std::get<2>(result));
+        return std::move(std::get<1>(result));
+    }
+};
+
+template <>
+struct task_promise<void> : task_promise_base {
+    std::exception_ptr error;
+
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {
+    }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    void take() {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+} // namespace detail
+
+template <typename T>
+class task {
+  public:
+    using promise_type = detail::task_promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() = default;
+
+    explicit task(handle_type h) noexcept : handle_(h) {
+    }
+
+    task(task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    task &operator=(task &&other) noexcept {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~task() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    // co_await task：记下调用者，切换到task自己的协程体
+    auto operator co_await() const noexcept {
+        struct awaiter {
+            handle_type h;
+
+            bool await_ready() const noexcept {
+                return !h || h.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                h.promise().continuation = caller;
+                return h;
+            }
+
+            T await_resume() {
+                return h.promise().take();
+            }
+        };
+        return awaiter{handle_};
+    }
+
+    // 供sync_wait等直接启动的场合使用
+    handle_type handle() const noexcept {
+        return handle_;
+    }
+
+  private:
+    handle_type handle_;
+};
+
+namespace detail {
+
+template <typename T>
+task<T> task_promise<T>::get_return_object() noexcept {
+    return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept {
+    return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+// sync_wait的完成标志放在sync_wait自己的栈上，协程帧里只存指针
+// 任务可能在其他线程结束：标志一旦发布，等待方随时会返回并销毁帧，
+// 所以通知方必须在锁内置位并notify，之后不再碰帧
+struct sync_wait_state {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+// sync_wait用的包装协程：等待task结束后置位标志，任务切到其他线程时调用方在标志上等
+struct sync_wait_task {
+    struct promise_type {
+        sync_wait_state *state = nullptr;
+
+        sync_wait_task get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+        // 挂起在终点，帧由sync_wait销毁
+        auto final_suspend() noexcept {
+            struct notifier {
+                bool await_ready() const noexcept {
+                    return false;
+                }
+                void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    sync_wait_state *st = h.promise().state;
+                    std::lock_guard lk(st->mtx);
+                    st->done = true;
+                    st->cv.notify_one();
+                }
+                void await_resume() const noexcept {
+                }
+            };
+            return notifier{};
+        }
+        void return_void() noexcept {
+        }
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> h;
+};
+
+template <typename T, typename Result>
+sync_wait_task make_sync_wait_task(task<T> &t, Result &result, std::exception_ptr &error) {
+    try {
+        if constexpr (std::is_void_v<T>)
+            co_await t;
+        else
+            result.template emplace<1>(co_await t);
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+} // namespace detail
+
+// 在当前线程上启动task并阻塞到结束，返回结果或重新抛出异常
+template <typename T>
+T sync_wait(task<T> t) {
+    using result_type = std::variant<std::monostate, std::conditional_t<std::is_void_v<T>, std::monostate, T>>;
+    result_type result;
+    std::exception_ptr error;
+    detail::sync_wait_state state;
+    auto w = detail::make_sync_wait_task(t, result, error);
+    w.h.promise().state = &state;
+    w.h.resume();
+    {
+        std::unique_lock lk(state.mtx);
+        state.cv.wait(lk, [&] { return state.done; });
+    }
+    w.h.destroy();
+    if (error)
+        std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>)
+        return std::move(std::get<1>(result));
+}
+
+} // namespace coro
@@ -0,0 +1,269 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// 协程帧的内存池
+// 上一级main.cpp里gen()、get_return()、foo()每调用一次都用全局operator new分配一个协程帧，
+// 大量短命协程时malloc/free占了主要开销。编译器分配协程帧时会先在promise_type里查找operator new，
+// 这里提供一个可以继承的pooled_promise：
+// 1) 默认从线程本地、按16字节分级的空闲链表分配，命中时只是弹出一个链表节点，不加锁
+// 2) 协程参数以(std::allocator_arg, alloc, ...)开头时改用调用方给的分配器，分配器拷贝存在帧的末尾
+// 3) 帧末尾还存了一个释放函数指针，operator delete(void *, size_t)据此选择释放方式
+namespace coro {
+
+// 线程本地、按大小分级的内存池
+// 块从64KB的chunk中顺序切出，释放后挂到当前线程对应级别的空闲链表上，chunk本身在进程退出时才归还
+// 在A线程分配、B线程释放的块进入B线程的链表，协程在一个线程创建、在调度器线程上结束时就是这样：
+// 1) 每级链表最多缓存cache_limit个块，超出时把batch个块一次性交给全局depot
+// 2) 本地链表空了先从depot取最多batch个块，depot也空了才切新的chunk
+// 这样分配线程和释放线程之间的块经由depot循环使用，内存不会随时间增长；线程退出时剩余的块也交给depot
+class frame_pool {
+  public:
+    static constexpr std::size_t granularity = 16;
+    static constexpr std::size_t max_size = 1024;
+    static constexpr std::size_t classes = max_size / granularity;
+    static constexpr std::size_t chunk_size = 64 * 1024;
+    static constexpr std::size_t cache_limit = 128;
+    static constexpr std::size_t batch = 64;
+
+    static void *allocate(std::size_t n) {
+        if (n > max_size)
+            return ::operator new(n);
+        return local().pop(index(n));
+    }
+
+    static void deallocate(void *p, std::size_t n) noexcept {
+        if (n > max_size) {
+            ::operator delete(p, n);
+            return;
+        }
+        local().push(index(n), p);
+    }
+
+  private:
+    struct block {
+        block *next;
+    };
+
+    static std::size_t index(std::size_t n) noexcept {
+        return n == 0 ? 0 : (n - 1) / granularity;
+    }
+
+    // 所有chunk，以及各线程交出来的空闲块
+    struct depot {
+        std::mutex m;
+        std::vector<void *> chunks;
+        std::array<block *, classes> lists{};
+        std::atomic<std::size_t> spare{0};
+
+        ~depot() {
+            for (auto *c : chunks)
+                ::operator delete(c);
+        }
+    };
+
+    static depot &global() {
+        static depot d;
+        return d;
+    }
+
+    struct cache {
+        std::array<block *, classes> lists{};
+        std::array<std::size_t, classes> counts{};
+        std::byte *cur = nullptr;
+        std::byte *end = nullptr;
+
+        // 先构造depot，保证它比任何线程的cache都晚析构
+        cache() {
+            global();
+        }
+
+        ~cache() {
+            auto &d = global();
+            std::lock_guard lg(d.m);
+            for (std::size_t i = 0; i < classes; ++i) {
+                if (!lists[i])
+                    continue;
+                auto *tail = lists[i];
+                while (tail->next)
+                    tail = tail->next;
+                tail->next = d.lists[i];
+                d.lists[i] = lists[i];
+                d.spare.fetch_add(counts[i], std::memory_order_relaxed);
+            }
+        }
+
+        void *pop(std::size_t i) {
+            if (auto *b = lists[i]) {
+                lists[i] = b->next;
+                --counts[i];
+                return b;
+            }
+            return refill(i);
+        }
+
+        void push(std::size_t i, void *p) {
+            auto *b = static_cast<block *>(p);
+            b->next = lists[i];
+            lists[i] = b;
+            if (++counts[i] > cache_limit)
+                spill(i);
+        }
+
+        // 把链表头部的batch个块交给depot，链表尾部的块保留在本地
+        void spill(std::size_t i) {
+            auto *head = lists[i];
+            auto *tail = head;
+            for (std::size_t k = 1; k < batch; ++k)
+                tail = tail->next;
+            lists[i] = tail->next;
+            counts[i] -= batch;
+            auto &d = global();
+            std::lock_guard lg(d.m);
+            tail->next = d.lists[i];
+            d.lists[i] = head;
+            d.spare.fetch_add(batch, std::memory_order_relaxed);
+        }
+
+        void *refill(std::size_t i) {
+            auto &d = global();
+            // depot通常是空的，先不加锁看一眼
+            if (d.spare.load(std::memory_order_relaxed) != 0) {
+                std::lock_guard lg(d.m);
+                if (auto *b = d.lists[i]) {
+                    // 最多取batch个，第一个直接返回，其余的放进本地链表
+                    auto *tail = b;
+                    std::size_t n = 1;
+                    for (; n < batch && tail->next; ++n)
+                        tail = tail->next;
+                    d.lists[i] = tail->next;
+                    d.spare.fetch_sub(n, std::memory_order_relaxed);
+                    tail->next = nullptr;
+                    lists[i] = b->next;
+                    counts[i] = n - 1;
+                    return b;
+                }
+            }
+            std::size_t size = (i + 1) * granularity;
+            if (static_cast<std::size_t>(end - cur) < size) {
+                auto *c = static_cast<std::byte *>(::operator new(chunk_size));
+                {
+                    std::lock_guard lg(d.m);
+                    d.chunks.push_back(c);
+                }
+                cur = c;
+                end = c + chunk_size;
+            }
+            auto *p = cur;
+            cur += size;
+            return p;
+        }
+    };
+
+    static cache &local() {
+        static thread_local cache c;
+        return c;
+    }
+};
+
+namespace detail {
+
+using frame_deleter = void (*)(void *frame, std::size_t n) noexcept;
+
+constexpr std::size_t align_up(std::size_t n, std::size_t a) noexcept {
+    return (n + a - 1) / a * a;
+}
+
+// 帧的布局：[协程帧 | 释放函数 | 分配器]
+constexpr std::size_t deleter_offset(std::size_t n) noexcept {
+    return align_up(n, alignof(frame_deleter));
+}
+
+inline frame_deleter &deleter_of(void *frame, std::size_t n) noexcept {
+    return *std::launder(reinterpret_cast<frame_deleter *>(static_cast<std::byte *>(frame) + deleter_offset(n)));
+}
+
+struct pool_frame {
+    static std::size_t total(std::size_t n) noexcept {
+        return deleter_offset(n) + sizeof(frame_deleter);
+    }
+
+    static void *allocate(std::size_t n) {
+        auto *p = frame_pool::allocate(total(n));
+        ::new (static_cast<std::byte *>(p) + deleter_offset(n)) frame_deleter(&deallocate);
+        return p;
+    }
+
+    static void deallocate(void *frame, std::size_t n) noexcept {
+        frame_pool::deallocate(frame, total(n));
+    }
+};
+
+// 按operator new的默认对齐分配，分配器rebind到这个类型上
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) frame_unit {
+    std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+};
+
+template <typename Alloc>
+struct allocator_frame {
+    using unit_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<frame_unit>;
+    using traits = std::allocator_traits<unit_alloc>;
+
+    static constexpr std::size_t alloc_offset(std::size_t n) noexcept {
+        return align_up(deleter_offset(n) + sizeof(frame_deleter), alignof(unit_alloc));
+    }
+
+    static constexpr std::size_t units(std::size_t n) noexcept {
+        return align_up(alloc_offset(n) + sizeof(unit_alloc), sizeof(frame_unit)) / sizeof(frame_unit);
+    }
+
+    static void *allocate(std::size_t n, const Alloc &a) {
+        unit_alloc ua(a);
+        auto *p = reinterpret_cast<std::byte *>(std::to_address(traits::allocate(ua, units(n))));
+        ::new (p + alloc_offset(n)) unit_alloc(std::move(ua));
+        ::new (p + deleter_offset(n)) frame_deleter(&deallocate);
+        return p;
+    }
+
+    static void deallocate(void *frame, std::size_t n) noexcept {
+        auto *p = static_cast<std::byte *>(frame);
+        auto *stored = std::launder(reinterpret_cast<unit_alloc *>(p + alloc_offset(n)));
+        unit_alloc ua(std::move(*stored));
+        stored->~unit_alloc();
+        traits::deallocate(ua, reinterpret_cast<frame_unit *>(p), units(n));
+    }
+};
+
+} // namespace detail
+
+// promise_type继承它即可
+// 普通协程：      task f(int x)                                         走frame_pool
+// 自带分配器：    task f(std::allocator_arg_t, const Alloc &a, int x)   走a
+// 成员函数协程：  第一个参数是对象本身，之后同上
+struct pooled_promise {
+    static void *operator new(std::size_t n) {
+        return detail::pool_frame::allocate(n);
+    }
+
+    template <typename Alloc, typename... Args>
+    static void *operator new(std::size_t n, std::allocator_arg_t, const Alloc &a, const Args &...) {
+        return detail::allocator_frame<Alloc>::allocate(n, a);
+    }
+
+    template <typename This, typename Alloc, typename... Args>
+    static void *operator new(std::size_t n, const This &, std::allocator_arg_t, const Alloc &a, const Args &...) {
+        return detail::allocator_frame<Alloc>::allocate(n, a);
+    }
+
+    // 编译器传入的n和operator new收到的相同，据此找到帧末尾的释放函数
+    static void operator delete(void *p, std::size_t n) noexcept {
+        detail::deleter_of(p, n)(p, n);
+    }
+};
+
+} // namespace coro
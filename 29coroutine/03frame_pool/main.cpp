@@ -0,0 +1,256 @@
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "../../common/count_new.hpp"
+#include "../01scheduler/scheduler.hpp"
+#include "frame_pool.hpp"
+
+// 1. 上一级main.cpp里的generator，promise_type继承pooled_promise
+struct generator {
+    struct promise_type : coro::pooled_promise {
+        int value_ = 0;
+
+        generator get_return_object() {
+            return generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+        std::suspend_always yield_value(int value) {
+            value_ = value;
+            return {};
+        }
+        void return_void() {
+        }
+    };
+
+    explicit generator(std::coroutine_handle<promise_type> h) : handle_(h) {
+    }
+    generator(generator &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+    ~generator() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool next() {
+        handle_.resume();
+        return !handle_.done();
+    }
+
+    int value() const {
+        return handle_.promise().value_;
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+generator gen(int n) {
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+}
+
+// 2. 第一个参数是allocator_arg时，帧从调用方给的分配器分配
+generator gen(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, int n) {
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+}
+
+// 3. 性能对比用的短命协程：创建、执行一次、销毁
+struct no_pool {};
+
+template <typename Base>
+struct job {
+    struct promise_type : Base {
+        long value = 0;
+
+        job get_return_object() {
+            return job{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+        void return_value(long v) {
+            value = v;
+        }
+    };
+
+    explicit job(std::coroutine_handle<promise_type> h) : handle_(h) {
+    }
+    job(job &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+    ~job() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    long run() {
+        handle_.resume();
+        return handle_.promise().value;
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename Base>
+job<Base> work(long i) {
+    co_return i * 2;
+}
+
+template <typename Alloc>
+job<coro::pooled_promise> work(std::allocator_arg_t, Alloc, long i) {
+    co_return i * 2;
+}
+
+template <typename Make>
+void bench(const char *name, long n, Make make) {
+    long sum = 0;
+    // 预热，让池和malloc都拿到内存
+    for (long i = 0; i < 1000; ++i)
+        sum += make(i).run();
+    auto calls = new_calls.load();
+    auto ms = time_ms([&] {
+        for (long i = 0; i < n; ++i)
+            sum += make(i).run();
+    });
+    std::cout << name << ms * 1e6 / n << " ns per coroutine, " << n / ms / 1000 << " M/s, global new "
+              << new_calls - calls << " (sum " << sum << ")\n";
+}
+
+// n个同时存活的协程占用的常驻内存(含保存句柄的vector)；销毁后再看一次，池不会把内存还给系统
+template <typename Make>
+void bench_rss(const char *name, long n, Make make) {
+    auto base = read_status().rss_kb;
+    long live = 0;
+    {
+        std::vector<decltype(make(0))> jobs;
+        jobs.reserve(n);
+        for (long i = 0; i < n; ++i)
+            jobs.push_back(make(i));
+        live = read_status().rss_kb - base;
+    }
+    std::cout << name << n << " live coroutines +" << live << " kB (" << live * 1024.0 / n
+              << " B each), after destroy +" << read_status().rss_kb - base << " kB\n";
+}
+
+// 5. 在一个线程创建、在调度器线程上结束的协程，结束时自动销毁
+template <typename Base>
+struct hop_task {
+    struct promise_type : Base {
+        hop_task get_return_object() noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+        void return_void() noexcept {
+        }
+    };
+};
+
+template <typename Base>
+hop_task<Base> hop(coro::scheduler &s, std::atomic<long> &finished) {
+    co_await s.schedule();
+    finished.fetch_add(1, std::memory_order_release);
+    finished.notify_one();
+}
+
+// 主线程每轮创建n个协程交给调度器，帧在主线程分配、在工作线程释放，每轮结束后看一次常驻内存
+// 释放线程的空闲链表有上限，多出来的块经depot回到主线程，
+// 所以frame_pool的内存和default new一样很快趋于平稳，不随轮数增长
+template <typename Base>
+void bench_cross_thread(const char *name, long n, int rounds) {
+    std::atomic<long> finished{0};
+    coro::scheduler s(2);
+    auto base = read_status().rss_kb;
+    std::cout << name << "rss after each round (kB):";
+    for (int r = 1; r <= rounds; ++r) {
+        for (long i = 0; i < n; ++i)
+            hop<Base>(s, finished);
+        for (long f; (f = finished.load(std::memory_order_acquire)) < n * r;)
+            finished.wait(f);
+        std::cout << " +" << read_status().rss_kb - base;
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    {
+        auto g = gen(10);
+        while (g.next())
+            std::cout << g.value() << " ";
+        std::cout << "\n";
+    }
+
+    // 帧大小相同的协程反复创建，第一次之后不再调用全局operator new
+    {
+        long sum = 0;
+        auto calls = new_calls.load();
+        for (int i = 0; i < 10000; ++i) {
+            auto g = gen(3);
+            while (g.next())
+                sum += g.value();
+        }
+        std::cout << "10000 pooled generators: global new " << new_calls - calls << ", sum " << sum << "\n";
+    }
+
+    // 帧放在栈上的缓冲区里
+    {
+        std::byte buf[1024];
+        std::pmr::monotonic_buffer_resource res(buf, sizeof(buf), std::pmr::null_memory_resource());
+        auto calls = new_calls.load();
+        auto g = gen(std::allocator_arg, &res, 5);
+        int sum = 0;
+        while (g.next())
+            sum += g.value();
+        std::cout << "generator on stack buffer: global new " << new_calls - calls << ", sum " << sum << "\n";
+    }
+
+    // 4. 性能：分配/释放吞吐和常驻内存
+    {
+        long n = argc > 1 ? std::atol(argv[1]) : 10'000'000;
+        bench("default new:    ", n, [](long i) { return work<no_pool>(i); });
+        bench("frame_pool:     ", n, [](long i) { return work<coro::pooled_promise>(i); });
+        std::pmr::unsynchronized_pool_resource pool;
+        bench("pmr pool (arg): ", n, [&](long i) {
+            return work(std::allocator_arg, std::pmr::polymorphic_allocator<>(&pool), i);
+        });
+
+        long live = n / 10;
+        bench_rss("default new:    ", live, [](long i) { return work<no_pool>(i); });
+        bench_rss("frame_pool:     ", live, [](long i) { return work<coro::pooled_promise>(i); });
+
+        bench_cross_thread<no_pool>("default new:    ", live, 10);
+        bench_cross_thread<coro::pooled_promise>("frame_pool:     ", live, 10);
+    }
+    return 0;
+}
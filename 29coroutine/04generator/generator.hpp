@@ -0,0 +1,233 @@
+#pragma once
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "../03frame_pool/frame_pool.hpp"
+
+// 通用的generator<T>，接口和c++23的std::generator一致(gcc12还没有)
+// 上一级main.cpp里的generator只能产出int，yield_value(int &)保存左值的地址，结束时next()返回-1，
+// 既不能产出右值，也不能用在范围for和views里。这里：
+// 1) reference默认是T&&，co_yield右值时只保存它的地址，不拷贝；co_yield左值时拷贝一份放在协程帧里
+// 2) 满足std::ranges::input_range和view，可以直接接 | std::views::filter 等
+// 3) co_yield elements_of(sub())递归展开子generator：子协程直接从父协程切入、结束时切回父协程，
+//    外层迭代器始终直接恢复最内层的协程，每个元素的开销和嵌套深度无关
+// 4) 协程帧由03frame_pool分配，参数以(std::allocator_arg, alloc)开头时使用指定的分配器
+namespace coro {
+
+// co_yield elements_of(r)：逐个产出r中的元素
+template <typename R>
+struct elements_of {
+    R range;
+};
+
+template <typename R>
+elements_of(R &&) -> elements_of<R &&>;
+
+template <typename Ref, typename V = void>
+class generator : public std::ranges::view_interface<generator<Ref, V>> {
+    using value = std::conditional_t<std::is_void_v<V>, std::remove_cvref_t<Ref>, V>;
+    using reference = std::conditional_t<std::is_void_v<V>, Ref &&, Ref>;
+    using yielded = std::conditional_t<std::is_reference_v<reference>, reference, const reference &>;
+
+  public:
+    class promise_type;
+    class iterator;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    class promise_type : public pooled_promise {
+      public:
+        generator get_return_object() noexcept {
+            auto h = handle_type::from_promise(*this);
+            top_ = h;
+            return generator(h);
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            return final_awaiter{};
+        }
+
+        // 右值和引用：只记下地址，在下一次恢复之前一直有效
+        std::suspend_always yield_value(yielded v) noexcept {
+            root_->value_ = std::addressof(v);
+            return {};
+        }
+
+        // reference是右值引用但co_yield了左值：拷贝到awaiter里，awaiter在挂起期间留在协程帧中
+        auto yield_value(const std::remove_reference_t<yielded> &lv)
+            requires std::is_rvalue_reference_v<yielded> &&
+                     std::constructible_from<std::remove_cvref_t<yielded>, const std::remove_reference_t<yielded> &>
+        {
+            struct copy_awaiter {
+                std::remove_cvref_t<yielded> v;
+
+                bool await_ready() const noexcept {
+                    return false;
+                }
+                void await_suspend(handle_type h) noexcept {
+                    h.promise().root_->value_ = std::addressof(v);
+                }
+                void await_resume() const noexcept {
+                }
+            };
+            return copy_awaiter{lv};
+        }
+
+        // 同类型的子generator：切换过去，由它直接产出
+        auto yield_value(elements_of<generator &&> sub) noexcept {
+            return nested_awaiter{std::move(sub.range)};
+        }
+
+        // 其他range：包装成一个子generator，元素是左值时按上面的规则拷贝
+        template <std::ranges::input_range R>
+            requires std::convertible_to<std::ranges::range_reference_t<R>, yielded> ||
+                     (std::is_rvalue_reference_v<yielded> &&
+                      std::convertible_to<std::ranges::range_reference_t<R>, const std::remove_reference_t<yielded> &>)
+        auto yield_value(elements_of<R> r) {
+            return nested_awaiter{flatten(std::forward<R>(r.range))};
+        }
+
+        void return_void() const noexcept {
+        }
+
+        // 最外层的异常直接从迭代器的++抛出，子generator的异常在父协程的co_yield处重新抛出
+        void unhandled_exception() {
+            if (root_ == this)
+                throw;
+            except_ = std::current_exception();
+        }
+
+        // generator里不能co_await
+        template <typename U>
+        void await_transform(U &&) = delete;
+
+      private:
+        friend class iterator;
+
+        struct final_awaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+            std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                auto &p = h.promise();
+                if (p.parent_) {
+                    p.root_->top_ = p.parent_;
+                    return p.parent_;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {
+            }
+        };
+
+        struct nested_awaiter {
+            generator sub;
+
+            bool await_ready() const noexcept {
+                return !sub.handle_;
+            }
+            std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                auto &child = sub.handle_.promise();
+                auto &parent = h.promise();
+                child.root_ = parent.root_;
+                child.parent_ = h;
+                parent.root_->top_ = sub.handle_;
+                return sub.handle_;
+            }
+            void await_resume() {
+                if (sub.handle_ && sub.handle_.promise().except_)
+                    std::rethrow_exception(sub.handle_.promise().except_);
+            }
+        };
+
+        template <typename R>
+        static generator flatten(R r) {
+            for (auto &&e : r)
+                co_yield std::forward<decltype(e)>(e);
+        }
+
+        std::add_pointer_t<yielded> value_ = nullptr;
+        std::exception_ptr except_;
+        promise_type *root_ = this;
+        handle_type parent_;
+        handle_type top_; // 只在最外层有意义：当前正在产出元素的协程
+    };
+
+    class iterator {
+      public:
+        using value_type = value;
+        using difference_type = std::ptrdiff_t;
+
+        iterator(iterator &&other) noexcept : h_(std::exchange(other.h_, nullptr)) {
+        }
+        iterator &operator=(iterator &&other) noexcept {
+            h_ = std::exchange(other.h_, nullptr);
+            return *this;
+        }
+
+        reference operator*() const noexcept {
+            return static_cast<reference>(*h_.promise().value_);
+        }
+
+        iterator &operator++() {
+            h_.promise().top_.resume();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept {
+            return it.h_.done();
+        }
+
+      private:
+        friend class generator;
+        explicit iterator(handle_type h) noexcept : h_(h) {
+        }
+
+        handle_type h_;
+    };
+
+    generator(generator &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    generator &operator=(generator other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+
+    ~generator() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    // 只能调用一次：启动协程，执行到第一个co_yield
+    iterator begin() {
+        handle_.resume();
+        return iterator(handle_);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+
+  private:
+    explicit generator(handle_type h) noexcept : handle_(h) {
+    }
+
+    handle_type handle_;
+};
+
+} // namespace coro
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "generator.hpp"
+
+// 1. 上一级main.cpp里的gen()，不再需要-1哨兵
+coro::generator<int> gen() {
+    for (int i = 0; i < 10; ++i)
+        co_yield i;
+}
+
+// 2. 产出只能移动的类型，co_yield右值不拷贝
+coro::generator<std::unique_ptr<std::string>> words() {
+    co_yield std::make_unique<std::string>("hello");
+    co_yield std::make_unique<std::string>("generator");
+}
+
+// 按引用产出容器里的元素，调用方可以修改
+coro::generator<int &> every_other(std::vector<int> &v) {
+    for (std::size_t i = 0; i < v.size(); i += 2)
+        co_yield v[i];
+}
+
+// 3. 递归：中序遍历二叉树
+struct node {
+    int value;
+    std::unique_ptr<node> left, right;
+};
+
+std::unique_ptr<node> build(int lo, int hi) {
+    if (lo >= hi)
+        return nullptr;
+    int mid = lo + (hi - lo) / 2;
+    return std::make_unique<node>(mid, build(lo, mid), build(mid + 1, hi));
+}
+
+coro::generator<int> inorder(const node *n) {
+    if (!n)
+        co_return;
+    co_yield coro::elements_of(inorder(n->left.get()));
+    co_yield n->value;
+    co_yield coro::elements_of(inorder(n->right.get()));
+}
+
+coro::generator<int> throws_after(int n) {
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+    throw std::runtime_error("generator failed");
+}
+
+// 4. 性能对比：产出同一个伪随机序列
+inline std::uint64_t step(std::uint64_t &x) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return x >> 33;
+}
+
+// 1) 手写的迭代器
+struct lcg_range {
+    std::uint64_t n;
+
+    struct iterator {
+        using value_type = std::uint64_t;
+        using difference_type = std::ptrdiff_t;
+
+        std::uint64_t x = 1, left = 0, cur = 0;
+
+        std::uint64_t operator*() const {
+            return cur;
+        }
+        iterator &operator++() {
+            --left;
+            cur = step(x);
+            return *this;
+        }
+        void operator++(int) {
+            ++*this;
+        }
+        friend bool operator==(const iterator &it, std::default_sentinel_t) {
+            return it.left == 0;
+        }
+    };
+
+    iterator begin() const {
+        iterator it{1, n, 0};
+        it.cur = step(it.x);
+        return it;
+    }
+    std::default_sentinel_t end() const {
+        return {};
+    }
+};
+
+// 2) generator
+coro::generator<std::uint64_t> lcg(std::uint64_t n) {
+    std::uint64_t x = 1;
+    for (std::uint64_t i = 0; i < n; ++i)
+        co_yield step(x);
+}
+
+// 3) 同样的序列经过depth层elements_of转发
+coro::generator<std::uint64_t> lcg_nested(std::uint64_t n, int depth) {
+    if (depth == 0)
+        co_yield coro::elements_of(lcg(n));
+    else
+        co_yield coro::elements_of(lcg_nested(n, depth - 1));
+}
+
+// 对照：每层都用范围for转发，每个元素要逐层恢复depth个协程
+coro::generator<std::uint64_t> lcg_forward(std::uint64_t n, int depth) {
+    if (depth == 0) {
+        co_yield coro::elements_of(lcg(n));
+        co_return;
+    }
+    for (auto x : lcg_forward(n, depth - 1))
+        co_yield x;
+}
+
+template <typename R>
+void bench(const std::string &name, std::uint64_t n, R &&r) {
+    std::uint64_t sum = 0;
+    auto ms = time_ms([&] {
+        for (auto x : r)
+            sum += x;
+    });
+    std::cout << std::left << std::setw(24) << name + ":" << ms * 1e6 / n << " ns per element (sum " << sum << ")\n";
+}
+
+int main(int argc, char *argv[]) {
+    for (int x : gen())
+        std::cout << x << " ";
+    std::cout << "\n";
+
+    static_assert(std::ranges::input_range<coro::generator<int>>);
+    static_assert(std::ranges::view<coro::generator<int>>);
+
+    // 和26range里的views组合
+    auto r = gen() | std::views::filter([](int x) { return x % 2 == 0; }) |
+             std::views::transform([](int x) { return x * x; });
+    int sum = 0;
+    for (int x : r)
+        sum += x;
+    std::cout << sum << "\n"; // 120
+
+    for (auto &&p : words())
+        std::cout << *p << " ";
+    std::cout << "\n";
+
+    std::vector v{1, 2, 3, 4, 5};
+    for (int &x : every_other(v))
+        x = 0;
+    for (int x : v)
+        std::cout << x << " "; // 0 2 0 4 0
+    std::cout << "\n";
+
+    // 任意range也可以elements_of
+    auto chained = [](std::vector<int> a) -> coro::generator<int> {
+        co_yield coro::elements_of(a);
+        co_yield coro::elements_of(std::views::iota(100, 103));
+    };
+    for (int x : chained({1, 2, 3}))
+        std::cout << x << " ";
+    std::cout << "\n";
+
+    auto tree = build(0, 15);
+    for (int x : inorder(tree.get()) | std::views::take(8))
+        std::cout << x << " ";
+    std::cout << "\n";
+
+    try {
+        for (int x : throws_after(3))
+            std::cout << x << " ";
+    } catch (const std::exception &e) {
+        std::cout << "caught: " << e.what() << "\n";
+    }
+
+    // 5. 性能
+    {
+        std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+        bench("hand-written iterator", n, lcg_range{n});
+        bench("generator", n, lcg(n));
+        for (int depth : {1, 8, 64})
+            bench("elements_of depth " + std::to_string(depth), n, lcg_nested(n, depth));
+        for (int depth : {1, 8})
+            bench("range-for depth " + std::to_string(depth), n, lcg_forward(n, depth));
+    }
+    return 0;
+}
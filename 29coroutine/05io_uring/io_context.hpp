@@ -0,0 +1,465 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "../../28multi_thread/05thread_pool/thread_pool.hpp"
+#include "../01scheduler/scheduler.hpp"
+
+// 协程的文件I/O：read、write、fsync、openat
+// 上一级main.cpp里唯一的awaitable只是睡眠，25new_stl_func的文件操作用的都是阻塞的ofstream和fs::copy
+// 这里：
+// 1) 优先用io_uring：直接走io_uring_setup/io_uring_enter系统调用(不依赖liburing)，
+//    由一个收割线程阻塞在io_uring_enter上取完成事件，一批完成事件按调度器一次性放回就绪队列
+// 2) 在调度器线程上发起时只填SQE不进内核，等这个线程取空就绪队列时(scheduler_core::defer)
+//    用一次io_uring_enter提交这段时间攒下的全部SQE；不在调度器上发起的立即提交
+// 3) 内核不支持io_uring(或被seccomp禁掉、缺少需要的opcode)时，
+//    退化为在05thread_pool上执行阻塞的pread/pwrite等
+// 4) 操作完成后，协程回到发起时所在的调度器(01scheduler)上恢复；
+//    不在调度器上发起的，直接在完成线程上恢复
+// 5) 结果为负的errno时，co_await处抛出std::system_error
+namespace coro {
+
+enum class io_backend { automatic, io_uring, thread_pool };
+
+class io_context;
+
+// 一次I/O操作，放在co_await表达式的awaiter里，挂起期间一直有效
+struct io_request {
+    std::uint8_t opcode = IORING_OP_NOP;
+    int fd = -1;
+    std::uint64_t addr = 0;
+    std::uint32_t len = 0;
+    std::uint64_t offset = 0;
+    int flags = 0;
+    mode_t mode = 0;
+
+    std::int32_t result = 0;
+    std::coroutine_handle<> handle{};
+    scheduler_core *core = nullptr;
+
+    // 完成：回到发起时的调度器，没有调度器时就地恢复
+    void complete(std::int32_t res) {
+        result = res;
+        if (core)
+            core->post(handle);
+        else
+            handle.resume();
+    }
+
+    // 退化路径：在当前线程上执行阻塞的系统调用，返回值和io_uring的cqe.res一致
+    std::int32_t run_blocking() const noexcept {
+        long r = -1;
+        switch (opcode) {
+        case IORING_OP_READ:
+            r = ::pread(fd, reinterpret_cast<void *>(addr), len, static_cast<off_t>(offset));
+            break;
+        case IORING_OP_WRITE:
+            r = ::pwrite(fd, reinterpret_cast<const void *>(addr), len, static_cast<off_t>(offset));
+            break;
+        case IORING_OP_FSYNC:
+            r = ::fsync(fd);
+            break;
+        case IORING_OP_OPENAT:
+            r = ::openat(fd, reinterpret_cast<const char *>(addr), flags, mode);
+            break;
+        default:
+            errno = EINVAL;
+        }
+        return r < 0 ? -errno : static_cast<std::int32_t>(r);
+    }
+};
+
+namespace detail {
+
+inline int io_uring_setup(unsigned entries, io_uring_params *p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+inline int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+inline int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// 共享内存里由内核和用户态同时访问的下标
+inline unsigned load_acquire(unsigned *p) noexcept {
+    return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+}
+
+inline void store_release(unsigned *p, unsigned v) noexcept {
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+// 原始的io_uring：提交队列(SQ)加锁后任何线程都可以提交，完成队列(CQ)只由收割线程消费
+class uring {
+  public:
+    // 失败时ok()为false，由io_context退化到线程池
+    explicit uring(unsigned entries) {
+        io_uring_params p{};
+        fd_ = io_uring_setup(entries, &p);
+        if (fd_ < 0)
+            return;
+        sq_entries_ = p.sq_entries;
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        single_mmap_ = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap_)
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) {
+            sq_ptr_ = nullptr;
+            return;
+        }
+        cq_ptr_ = single_mmap_ ? sq_ptr_
+                               : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                        IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            cq_ptr_ = nullptr;
+            return;
+        }
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        auto *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            return;
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        auto *sq = static_cast<char *>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        auto *cq = static_cast<char *>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+    }
+
+    uring(const uring &) = delete;
+    uring &operator=(const uring &) = delete;
+
+    ~uring() {
+        if (sqes_)
+            ::munmap(sqes_, sqes_size_);
+        if (cq_ptr_ && !single_mmap_)
+            ::munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_)
+            ::munmap(sq_ptr_, sq_size_);
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    bool ok() const noexcept {
+        return sqes_ != nullptr;
+    }
+
+    // 用IORING_REGISTER_PROBE确认内核支持这些opcode(5.6以前没有READ/WRITE/OPENAT)
+    bool supports(std::initializer_list<std::uint8_t> ops) const {
+        constexpr unsigned n = 256;
+        auto buf = std::make_unique<char[]>(sizeof(io_uring_probe) + n * sizeof(io_uring_probe_op));
+        std::memset(buf.get(), 0, sizeof(io_uring_probe) + n * sizeof(io_uring_probe_op));
+        auto *probe = reinterpret_cast<io_uring_probe *>(buf.get());
+        if (io_uring_register(fd_, IORING_REGISTER_PROBE, probe, n) < 0)
+            return false;
+        for (auto op : ops) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+
+    // 填一个SQE但不进内核，由flush统一提交；SQ满时先提交已有的，返回负的errno表示失败
+    template <typename F>
+    int queue(const io_request &r, std::uint64_t user_data, F &&on_fail) {
+        std::unique_lock lk(sq_mtx_);
+        if (*sq_tail_ - load_acquire(sq_head_) == sq_entries_) {
+            std::vector<std::uint64_t> failed;
+            if (int err = flush_locked(failed); err < 0) {
+                lk.unlock();
+                for (auto u : failed)
+                    on_fail(u, err);
+                return err;
+            }
+        }
+        unsigned tail = *sq_tail_;
+        unsigned idx = tail & sq_mask_;
+        auto *sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = r.opcode;
+        sqe->fd = r.fd;
+        sqe->addr = r.addr;
+        sqe->len = r.len;
+        sqe->off = r.offset;
+        if (r.opcode == IORING_OP_OPENAT) {
+            sqe->open_flags = static_cast<std::uint32_t>(r.flags);
+            sqe->len = r.mode;
+        }
+        sqe->user_data = user_data;
+        sq_array_[idx] = idx;
+        store_release(sq_tail_, tail + 1);
+        return 0;
+    }
+
+    // 一次io_uring_enter提交全部已填的SQE
+    // 内核拒绝时撤回还没取走的SQE，解锁后对每个调用on_fail(user_data, -errno)，返回负的errno
+    // on_fail可能就地恢复协程，协程又会提交新的请求，所以不能在锁内调用
+    template <typename F>
+    int flush(F &&on_fail) {
+        std::vector<std::uint64_t> failed;
+        int err;
+        {
+            std::lock_guard lg(sq_mtx_);
+            err = flush_locked(failed);
+        }
+        for (auto u : failed)
+            on_fail(u, err);
+        return err;
+    }
+
+    // 阻塞直到至少有一个完成事件，对每个事件调用f(user_data, res)
+    template <typename F>
+    void reap(F &&f) {
+        unsigned head = *cq_head_;
+        unsigned tail = load_acquire(cq_tail_);
+        if (head == tail) {
+            io_uring_enter(fd_, 0, 1, IORING_ENTER_GETEVENTS);
+            return;
+        }
+        for (; head != tail; ++head) {
+            auto cqe = cqes_[head & cq_mask_];
+            // 先把槽位还给内核再处理，处理过程中可能又提交新的请求
+            store_release(cq_head_, head + 1);
+            f(cqe.user_data, cqe.res);
+        }
+    }
+
+    unsigned entries() const noexcept {
+        return sq_entries_;
+    }
+
+  private:
+    // 没有开SQPOLL，io_uring_enter返回时内核已经取走了它提交的SQE，sq_head_随之前进
+    int flush_locked(std::vector<std::uint64_t> &failed) {
+        for (;;) {
+            unsigned head = load_acquire(sq_head_);
+            unsigned pending = *sq_tail_ - head;
+            if (pending == 0)
+                return 0;
+            int ret = io_uring_enter(fd_, pending, 0, 0);
+            if (ret > 0)
+                continue;
+            if (ret < 0 && errno == EINTR)
+                continue;
+            int err = ret < 0 ? errno : EAGAIN;
+            head = load_acquire(sq_head_);
+            for (unsigned i = head; i != *sq_tail_; ++i)
+                failed.push_back(sqes_[sq_array_[i & sq_mask_]].user_data);
+            store_release(sq_tail_, head);
+            return -err;
+        }
+    }
+
+    int fd_ = -1;
+    bool single_mmap_ = false;
+    void *sq_ptr_ = nullptr;
+    void *cq_ptr_ = nullptr;
+    std::size_t sq_size_ = 0, cq_size_ = 0, sqes_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned *sq_head_ = nullptr, *sq_tail_ = nullptr, *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr;
+    unsigned sq_mask_ = 0, cq_mask_ = 0, sq_entries_ = 0;
+    std::mutex sq_mtx_;
+};
+
+} // namespace detail
+
+// co_await ctx.read(...)等返回的awaiter
+class io_awaiter {
+  public:
+    io_awaiter(io_context &ctx, io_request r) noexcept : ctx_(ctx), req_(r) {
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    // 提交失败时不挂起，直接在await_resume里报告错误
+    // 提交成功后操作可能立即在别的线程上完成并恢复协程，之后不能再访问this
+    bool await_suspend(std::coroutine_handle<> h);
+
+    std::int32_t await_resume() const {
+        if (req_.result < 0)
+            throw std::system_error(-req_.result, std::system_category());
+        return req_.result;
+    }
+
+  private:
+    io_context &ctx_;
+    io_request req_;
+};
+
+class io_context {
+  public:
+    // entries：io_uring的队列长度；fallback_threads：退化时线程池的线程数
+    explicit io_context(unsigned entries = 256, unsigned fallback_threads = 4,
+                        io_backend backend = io_backend::automatic) {
+        if (backend != io_backend::thread_pool) {
+            auto ring = std::make_unique<detail::uring>(entries);
+            if (ring->ok() &&
+                ring->supports({IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_OPENAT, IORING_OP_NOP})) {
+                ring_ = std::move(ring);
+                reaper_ = std::jthread([this] { reap_loop(); });
+            } else if (backend == io_backend::io_uring) {
+                throw std::system_error(errno ? errno : ENOSYS, std::system_category(), "io_uring unavailable");
+            }
+        }
+        if (!ring_)
+            pool_.emplace(fallback_threads);
+    }
+
+    io_context(const io_context &) = delete;
+    io_context &operator=(const io_context &) = delete;
+
+    // 析构前所有操作必须已经完成
+    ~io_context() {
+        if (ring_) {
+            // user_data为0的NOP通知收割线程退出
+            io_request stop{.opcode = IORING_OP_NOP, .fd = -1};
+            auto ignore = [](std::uint64_t, std::int32_t) {};
+            while (ring_->queue(stop, 0, ignore) < 0 || ring_->flush(ignore) < 0)
+                std::this_thread::yield();
+            reaper_.join();
+        }
+    }
+
+    io_backend backend() const noexcept {
+        return ring_ ? io_backend::io_uring : io_backend::thread_pool;
+    }
+
+    io_awaiter read(int fd, void *buf, std::uint32_t len, std::uint64_t offset) {
+        return {*this,
+                {.opcode = IORING_OP_READ,
+                 .fd = fd,
+                 .addr = reinterpret_cast<std::uint64_t>(buf),
+                 .len = len,
+                 .offset = offset}};
+    }
+
+    io_awaiter write(int fd, const void *buf, std::uint32_t len, std::uint64_t offset) {
+        return {*this,
+                {.opcode = IORING_OP_WRITE,
+                 .fd = fd,
+                 .addr = reinterpret_cast<std::uint64_t>(buf),
+                 .len = len,
+                 .offset = offset}};
+    }
+
+    io_awaiter fsync(int fd) {
+        return {*this, {.opcode = IORING_OP_FSYNC, .fd = fd}};
+    }
+
+    // path在co_await结束前必须有效；结果是新的文件描述符
+    io_awaiter openat(int dirfd, const char *path, int flags, mode_t mode = 0) {
+        return {*this,
+                {.opcode = IORING_OP_OPENAT,
+                 .fd = dirfd,
+                 .addr = reinterpret_cast<std::uint64_t>(path),
+                 .flags = flags,
+                 .mode = mode}};
+    }
+
+  private:
+    friend class io_awaiter;
+
+    // 返回false表示没有提交成功，r.result里是错误码
+    bool submit(io_request &r) {
+        if (!ring_) {
+            pool_->post([&r] { r.complete(r.run_blocking()); });
+            return true;
+        }
+        if (int err = ring_->queue(r, reinterpret_cast<std::uint64_t>(&r), fail); err < 0) {
+            r.result = err;
+            return false;
+        }
+        if (r.core)
+            scheduler_core::defer(&io_context::flush, this);
+        else
+            ring_->flush(fail);
+        return true;
+    }
+
+    static void flush(void *self) {
+        static_cast<io_context *>(self)->ring_->flush(fail);
+    }
+
+    // 已经挂起的请求提交失败，和完成一样处理
+    static void fail(std::uint64_t user_data, std::int32_t err) {
+        if (user_data)
+            reinterpret_cast<io_request *>(user_data)->complete(err);
+    }
+
+    // 同一批完成事件里回到同一个调度器的协程一起放回去，只加一次锁
+    void reap_loop() {
+        bool stop = false;
+        std::vector<std::coroutine_handle<>> batch;
+        scheduler_core *batch_core = nullptr;
+        auto flush_batch = [&] {
+            batch_core->post(batch);
+            batch.clear();
+        };
+        while (!stop) {
+            ring_->reap([&](std::uint64_t user_data, std::int32_t res) {
+                if (user_data == 0) {
+                    stop = true;
+                    return;
+                }
+                auto *r = reinterpret_cast<io_request *>(user_data);
+                if (!r->core) {
+                    r->complete(res);
+                    return;
+                }
+                r->result = res;
+                if (r->core != batch_core && !batch.empty())
+                    flush_batch();
+                batch_core = r->core;
+                batch.push_back(r->handle);
+            });
+            if (!batch.empty())
+                flush_batch();
+        }
+    }
+
+    std::unique_ptr<detail::uring> ring_;
+    std::jthread reaper_;
+    std::optional<thread_pool> pool_;
+};
+
+inline bool io_awaiter::await_suspend(std::coroutine_handle<> h) {
+    req_.handle = h;
+    req_.core = scheduler_core::current();
+    return ctx_.submit(req_);
+}
+
+} // namespace coro
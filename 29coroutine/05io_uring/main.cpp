@@ -0,0 +1,139 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../common/bench.hpp"
+#include "../02task/task.hpp"
+#include "io_context.hpp"
+
+const char *backend_name(coro::io_backend b) {
+    return b == coro::io_backend::io_uring ? "io_uring" : "thread_pool";
+}
+
+// 1. 25new_stl_func里用ofstream写文件，这里全部用co_await完成
+coro::task<std::string> write_and_read(coro::io_context &io, const std::string &path) {
+    int fd = co_await io.openat(AT_FDCWD, path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+    std::string msg = "Hello world\n";
+    co_await io.write(fd, msg.data(), msg.size(), 0);
+    co_await io.fsync(fd);
+    std::string back(msg.size(), '\0');
+    auto n = co_await io.read(fd, back.data(), back.size(), 0);
+    ::close(fd);
+    back.resize(n);
+    co_return back;
+}
+
+coro::task<> open_missing(coro::io_context &io) {
+    try {
+        co_await io.openat(AT_FDCWD, "/nonexistent/file", O_RDONLY);
+    } catch (const std::system_error &e) {
+        std::cout << "openat failed: " << e.what() << "\n";
+    }
+}
+
+// 2. 在调度器上发起读，完成后回到调度器线程
+coro::detached reader(coro::io_context &io, coro::scheduler &s, int fd, std::uint64_t blocks, int ops,
+                      std::uint32_t seed, std::latch &done) {
+    co_await s.schedule();
+    auto *buf = static_cast<char *>(std::aligned_alloc(4096, 4096));
+    std::minstd_rand rng(seed);
+    for (int i = 0; i < ops; ++i)
+        co_await io.read(fd, buf, 4096, rng() % blocks * 4096);
+    std::free(buf);
+    done.count_down();
+}
+
+void blocking_reader(int fd, std::uint64_t blocks, int ops, std::uint32_t seed) {
+    auto *buf = static_cast<char *>(std::aligned_alloc(4096, 4096));
+    std::minstd_rand rng(seed);
+    for (int i = 0; i < ops; ++i)
+        if (::pread(fd, buf, 4096, static_cast<off_t>(rng() % blocks * 4096)) != 4096)
+            std::abort();
+    std::free(buf);
+}
+
+int main(int argc, char *argv[]) {
+    namespace fs = std::filesystem;
+    auto dir = fs::temp_directory_path();
+
+    for (auto b : {coro::io_backend::automatic, coro::io_backend::thread_pool}) {
+        coro::io_context io(64, 2, b);
+        // 不在调度器上，协程在完成线程上恢复，sync_wait在主线程上等
+        auto path = (dir / "io_uring_demo.txt").string();
+        std::cout << backend_name(io.backend()) << ": " << coro::sync_wait(write_and_read(io, path));
+        coro::sync_wait(open_missing(io));
+        fs::remove(path);
+    }
+
+    // 3. 性能：4KB随机读，队列深度1到256
+    // 1) io_uring：qd个协程在单线程调度器上并发发起读
+    // 2) 05thread_pool上qd个线程各自阻塞pread
+    // 默认用O_DIRECT绕过页缓存，测到的主要是设备；文件系统不支持或第三个参数为cached时走页缓存，
+    // 读都在提交时就完成，测到的是每次操作的系统调用和调度开销，批量提交的差别在这里最明显
+    {
+        int total = argc > 1 ? std::atoi(argv[1]) : 20'000;
+        std::uint64_t file_mb = argc > 2 ? std::atoi(argv[2]) : 256;
+        std::uint64_t blocks = file_mb * 256;
+        auto path = (dir / "io_uring_bench.dat").string();
+        {
+            int fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+            std::vector<char> chunk(1 << 20, 'x');
+            for (std::uint64_t i = 0; i < file_mb; ++i)
+                if (::write(fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size()))
+                    std::abort();
+            ::fsync(fd);
+            ::close(fd);
+        }
+        bool cached = argc > 3 && std::string(argv[3]) == "cached";
+        int fd = cached ? -1 : ::open(path.c_str(), O_RDONLY | O_DIRECT);
+        if (fd < 0 && cached) {
+            fd = ::open(path.c_str(), O_RDONLY);
+        } else if (fd < 0) {
+            std::cout << "O_DIRECT unsupported, using page cache\n";
+            fd = ::open(path.c_str(), O_RDONLY);
+        }
+
+        std::cout << file_mb << " MB file, " << total << " random 4KB reads per point\n";
+        coro::io_context io(512);
+        std::cout << "backend: " << backend_name(io.backend()) << "\n";
+        for (int qd = 1; qd <= 256; qd *= 2) {
+            int per = total / qd;
+            int n = per * qd;
+            auto uring_ms = time_ms([&] {
+                coro::scheduler s(1);
+                std::latch done(qd);
+                for (int i = 0; i < qd; ++i)
+                    reader(io, s, fd, blocks, per, i + 1, done);
+                done.wait();
+            });
+            auto pool_ms = time_ms([&] {
+                thread_pool pool(qd);
+                std::latch done(qd);
+                for (int i = 0; i < qd; ++i)
+                    pool.post([&, i] {
+                        blocking_reader(fd, blocks, per, i + 1);
+                        done.count_down();
+                    });
+                done.wait();
+            });
+            std::cout << "qd " << qd << ":\tio_uring " << static_cast<long>(n / uring_ms * 1000) << " IOPS, "
+                      << uring_ms * 1000 * qd / n << " us avg;\tpread pool " << static_cast<long>(n / pool_ms * 1000)
+                      << " IOPS, " << pool_ms * 1000 * qd / n << " us avg\n";
+        }
+        ::close(fd);
+        fs::remove(path);
+    }
+    return 0;
+}
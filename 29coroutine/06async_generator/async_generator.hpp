@@ -0,0 +1,168 @@
+#pragma once
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+#include "../02task/task.hpp"
+#include "../03frame_pool/frame_pool.hpp"
+
+// 异步generator：协程体里既可以co_yield，也可以co_await(I/O、sleep_for、其他task)
+// 上一级main.cpp里的generator是同步的，genreturn只能返回一个值；04generator的generator<T>禁止co_await。这里：
+// 1) 消费者用co_await g.next()取下一个元素，得到std::optional<T>，结束时为空；或者用for_each(g, f)
+// 2) 背压：生产者只在消费者调用next()时才运行，产出一个元素后就挂起，中间不缓存任何元素
+// 3) 切换都是对称转移：next()直接切到生产者，co_yield直接切回消费者，不经过调度器
+//    和02task一样依赖编译器把切换做成尾调用，-O0或开了AddressSanitizer时长流水线会栈溢出
+// 4) 取消：协程的第一个参数是std::stop_token时，promise会保存它；请求停止后next()直接返回空，不再恢复生产者。
+//    生产者自己在co_await之间也可以检查这个token。销毁generator会销毁挂起的协程帧，局部对象正常析构
+// 5) 生产者抛出的异常在消费者的co_await g.next()处重新抛出
+namespace coro {
+
+template <typename T>
+class async_generator {
+  public:
+    class promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    class promise_type : public pooled_promise {
+      public:
+        promise_type() = default;
+
+        // 编译器会先尝试用协程的参数构造promise，第一个参数是stop_token时走这里
+        template <typename... Args>
+        explicit promise_type(const std::stop_token &st, const Args &...) : stop_(st) {
+        }
+
+        async_generator get_return_object() noexcept {
+            return async_generator(handle_type::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            return yield_awaiter{};
+        }
+
+        // 右值只记下地址，消费者从这里移走
+        auto yield_value(T &&v) noexcept {
+            value_ = std::addressof(v);
+            return yield_awaiter{};
+        }
+
+        // 左值拷贝一份放在协程帧里
+        auto yield_value(const T &v)
+            requires std::copy_constructible<T>
+        {
+            struct copy_awaiter : yield_awaiter {
+                T copy;
+
+                std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                    h.promise().value_ = std::addressof(copy);
+                    return yield_awaiter::await_suspend(h);
+                }
+            };
+            return copy_awaiter{{}, v};
+        }
+
+        void return_void() const noexcept {
+        }
+
+        void unhandled_exception() noexcept {
+            except_ = std::current_exception();
+        }
+
+        const std::stop_token &get_stop_token() const noexcept {
+            return stop_;
+        }
+
+      private:
+        friend class async_generator;
+
+        // co_yield和结束时切回正在等待next()的消费者
+        struct yield_awaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+            std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                return h.promise().consumer_;
+            }
+            void await_resume() const noexcept {
+            }
+        };
+
+        T *value_ = nullptr;
+        std::exception_ptr except_;
+        std::coroutine_handle<> consumer_;
+        std::stop_token stop_;
+    };
+
+    async_generator(async_generator &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    async_generator &operator=(async_generator other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+
+    ~async_generator() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    // co_await g.next()：恢复生产者直到它产出下一个元素或者结束
+    auto next() noexcept {
+        struct awaiter {
+            handle_type h;
+            bool resumed = false;
+
+            bool await_ready() const noexcept {
+                return !h || h.done() || h.promise().stop_.stop_requested();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+                auto &p = h.promise();
+                p.consumer_ = consumer;
+                p.value_ = nullptr;
+                resumed = true;
+                return h;
+            }
+
+            std::optional<T> await_resume() {
+                if (!resumed)
+                    return std::nullopt;
+                auto &p = h.promise();
+                if (p.except_)
+                    std::rethrow_exception(std::exchange(p.except_, nullptr));
+                if (h.done())
+                    return std::nullopt;
+                return std::optional<T>(std::move(*p.value_));
+            }
+        };
+        return awaiter{handle_};
+    }
+
+  private:
+    explicit async_generator(handle_type h) noexcept : handle_(h) {
+    }
+
+    handle_type handle_;
+};
+
+// 相当于 for co_await (auto &&v : g) f(v); f返回task<>时逐个等待它完成
+template <typename T, typename F>
+task<> for_each(async_generator<T> &g, F f) {
+    while (auto v = co_await g.next()) {
+        if constexpr (std::is_same_v<std::invoke_result_t<F &, T &>, task<>>)
+            co_await f(*v);
+        else
+            f(*v);
+    }
+}
+
+} // namespace coro
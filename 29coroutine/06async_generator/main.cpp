@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../common/bench.hpp"
+#include "../04generator/generator.hpp"
+#include "../05io_uring/io_context.hpp"
+#include "async_generator.hpp"
+
+using namespace std::chrono_literals;
+
+// 1. 记录读取器：每读一块co_await一次I/O，按行产出
+coro::async_generator<std::string> lines(coro::io_context &io, int fd) {
+    char buf[16];
+    std::string line;
+    std::uint64_t offset = 0;
+    for (;;) {
+        auto n = co_await io.read(fd, buf, sizeof(buf), offset);
+        if (n == 0)
+            break;
+        offset += n;
+        for (int i = 0; i < n; ++i) {
+            if (buf[i] != '\n') {
+                line += buf[i];
+                continue;
+            }
+            co_yield std::move(line);
+            line.clear();
+        }
+    }
+    if (!line.empty())
+        co_yield std::move(line);
+}
+
+// 2. 取消：第一个参数是stop_token，请求停止后消费者的next()直接结束
+struct cleanup {
+    ~cleanup() {
+        std::cout << "ticker frame destroyed\n";
+    }
+};
+
+coro::async_generator<int> ticker(std::stop_token st) {
+    cleanup c;
+    for (int i = 0; !st.stop_requested(); ++i) {
+        co_await coro::sleep_for(10ms);
+        co_yield i;
+    }
+}
+
+coro::async_generator<int> faulty() {
+    co_yield 1;
+    throw std::runtime_error("producer failed");
+}
+
+// 3. 性能：source -> map -> filter 三级异步流水线
+struct record {
+    std::uint64_t id;
+    std::uint64_t value;
+};
+
+coro::async_generator<record> source(std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i)
+        co_yield record{i, i * 7};
+}
+
+coro::async_generator<record> scale(coro::async_generator<record> in) {
+    while (auto r = co_await in.next()) {
+        r->value *= 3;
+        co_yield std::move(*r);
+    }
+}
+
+coro::async_generator<record> drop_every_4th(coro::async_generator<record> in) {
+    while (auto r = co_await in.next())
+        if (r->id % 4 != 0)
+            co_yield std::move(*r);
+}
+
+coro::task<std::uint64_t> sink(coro::async_generator<record> in) {
+    std::uint64_t sum = 0;
+    while (auto r = co_await in.next())
+        sum += r->value;
+    co_return sum;
+}
+
+// 对照：同样三级，用04generator的同步generator
+coro::generator<record> sync_source(std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i)
+        co_yield record{i, i * 7};
+}
+
+coro::generator<record> sync_scale(coro::generator<record> in) {
+    for (auto r : in) {
+        r.value *= 3;
+        co_yield std::move(r);
+    }
+}
+
+coro::generator<record> sync_drop_every_4th(coro::generator<record> in) {
+    for (auto r : in)
+        if (r.id % 4 != 0)
+            co_yield std::move(r);
+}
+
+int main(int argc, char *argv[]) {
+    namespace fs = std::filesystem;
+    {
+        auto path = (fs::temp_directory_path() / "async_generator_demo.txt").string();
+        std::ofstream(path) << "first record\nsecond record, a bit longer than one block\nthird\nlast without newline";
+        coro::io_context io;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        auto g = lines(io, fd);
+        coro::sync_wait(coro::for_each(g, [](std::string &s) { std::cout << "[" << s << "]\n"; }));
+        ::close(fd);
+        fs::remove(path);
+    }
+
+    {
+        std::stop_source ss;
+        auto g = ticker(ss.get_token());
+        coro::sync_wait(coro::for_each(g, [&](int i) {
+            std::cout << "tick " << i << "\n";
+            if (i == 2)
+                ss.request_stop();
+        }));
+        std::cout << "stopped\n";
+    }
+
+    {
+        auto g = faulty();
+        try {
+            coro::sync_wait(coro::for_each(g, [](int i) { std::cout << "got " << i << "\n"; }));
+        } catch (const std::exception &e) {
+            std::cout << "caught: " << e.what() << "\n";
+        }
+    }
+
+    {
+        std::uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+        std::uint64_t sum = 0;
+        auto ms = time_ms([&] {
+            for (std::uint64_t i = 0; i < n; ++i)
+                if (i % 4 != 0)
+                    sum += i * 7 * 3;
+        });
+        std::cout << "plain loop:       " << ms * 1e6 / n << " ns per record (sum " << sum << ")\n";
+
+        sum = 0;
+        ms = time_ms([&] {
+            for (auto r : sync_drop_every_4th(sync_scale(sync_source(n))))
+                sum += r.value;
+        });
+        std::cout << "sync generator:   " << ms * 1e6 / n << " ns per record (sum " << sum << ")\n";
+
+        ms = time_ms([&] { sum = coro::sync_wait(sink(drop_every_4th(scale(source(n))))); });
+        std::cout << "async generator:  " << ms * 1e6 / n << " ns per record (sum " << sum << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,468 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../01scheduler/scheduler.hpp"
+#include "../02task/task.hpp"
+
+// 协程版本的同步原语：async_mutex、async_semaphore、async_latch、async_condition_variable
+// 28multi_thread/03sync_primitive里的mutex、counting_semaphore、latch、condition_variable都会阻塞线程，
+// 协程在调度器线程上用它们会把整个线程卡住，同一线程上的其他协程也跟着停下。这里：
+// 1) 需要等待时挂起协程，把等待节点(就在awaiter里，不额外分配)用CAS挂到无锁的侵入式链表上
+// 2) 唤醒时把等待节点交还给它挂起时所在的调度器(01scheduler)，没有调度器时就地恢复，和05io_uring一致
+// 3) async_mutex解锁时直接把锁的所有权交给下一个等待者，被唤醒的协程不需要再抢一次锁，也不会被插队
+// 4) 各链表只在整体取走(exchange)之后才读next，不存在ABA问题
+// 5) 取走的等待者放进一个私有的FIFO，只有当前的持有者能访问(async_mutex是持锁者，
+//    async_semaphore和async_condition_variable是正在分发的那个线程)，新来的等待者只会排在它们后面，严格FIFO
+namespace coro {
+
+namespace detail {
+
+struct waiter_node {
+    waiter_node *next = nullptr;
+    std::coroutine_handle<> handle;
+    scheduler_core *core = nullptr;
+
+    void prepare(std::coroutine_handle<> h) noexcept {
+        handle = h;
+        core = scheduler_core::current();
+    }
+
+    void resume() {
+        if (core)
+            core->post(handle);
+        else
+            handle.resume();
+    }
+};
+
+// 把LIFO的栈反转成FIFO
+inline waiter_node *reverse(waiter_node *head) noexcept {
+    waiter_node *prev = nullptr;
+    while (head)
+        head = std::exchange(head->next, std::exchange(prev, head));
+    return prev;
+}
+
+// 从等待者栈上取走的节点，按到达顺序排队；不是线程安全的，由持有者独占
+class waiter_fifo {
+  public:
+    bool empty() const noexcept {
+        return head_ == nullptr;
+    }
+
+    // stack是整体取走的栈，栈顶是最后到达的，反转后接到队尾
+    void append_stack(waiter_node *stack) noexcept {
+        if (!stack)
+            return;
+        auto *first = reverse(stack);
+        if (head_)
+            tail_->next = first;
+        else
+            head_ = first;
+        tail_ = stack;
+    }
+
+    waiter_node *pop() noexcept {
+        auto *w = head_;
+        head_ = w->next;
+        return w;
+    }
+
+  private:
+    waiter_node *head_ = nullptr;
+    waiter_node *tail_ = nullptr;
+};
+
+// 同一时刻只允许一个线程分发：计数从0加上去的那个成为分发者，
+// 其他线程只把请求加到计数上就返回，由分发者循环处理到计数归零
+template <typename Dispatch>
+void dispatch_serialized(std::atomic<std::uint64_t> &pending, std::uint64_t r, Dispatch &&dispatch) {
+    if (pending.fetch_add(r, std::memory_order_acq_rel) != 0)
+        return;
+    for (;;) {
+        dispatch(r);
+        auto left = pending.fetch_sub(r, std::memory_order_acq_rel) - r;
+        if (left == 0)
+            return;
+        r = left;
+    }
+}
+
+} // namespace detail
+
+class async_mutex;
+
+// co_await m.scoped_lock()的结果，析构时解锁
+class async_lock_guard {
+  public:
+    explicit async_lock_guard(async_mutex &m, std::adopt_lock_t) noexcept : m_(&m) {
+    }
+    async_lock_guard(async_lock_guard &&other) noexcept : m_(std::exchange(other.m_, nullptr)) {
+    }
+    async_lock_guard &operator=(async_lock_guard &&) = delete;
+    ~async_lock_guard();
+
+  private:
+    async_mutex *m_;
+};
+
+// 状态：not_locked、locked_no_waiters，或者指向等待者栈顶的指针(已加锁且有人等)
+// 持锁者另外维护一个FIFO链表waiters_，解锁时先从这里取，空了再把栈整体取走反转过来
+class async_mutex {
+    static constexpr std::uintptr_t not_locked = 1;
+    static constexpr std::uintptr_t locked_no_waiters = 0;
+
+    class lock_awaiter {
+      public:
+        explicit lock_awaiter(async_mutex &m) noexcept : m_(m) {
+        }
+
+        bool await_ready() noexcept {
+            return m_.try_lock();
+        }
+
+        // 挂起前再试一次：锁在这期间被释放了就直接拿到，不挂起
+        bool await_suspend(std::coroutine_handle<> h) noexcept {
+            node_.prepare(h);
+            return m_.enqueue(&node_);
+        }
+
+        void await_resume() const noexcept {
+        }
+
+      protected:
+        async_mutex &m_;
+
+      private:
+        detail::waiter_node node_;
+    };
+
+    class scoped_lock_awaiter : public lock_awaiter {
+      public:
+        using lock_awaiter::lock_awaiter;
+
+        async_lock_guard await_resume() const noexcept {
+            return async_lock_guard(m_, std::adopt_lock);
+        }
+    };
+
+  public:
+    async_mutex() = default;
+    async_mutex(const async_mutex &) = delete;
+    async_mutex &operator=(const async_mutex &) = delete;
+
+    bool try_lock() noexcept {
+        auto s = not_locked;
+        return state_.compare_exchange_strong(s, locked_no_waiters, std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+    }
+
+    // co_await m.lock(); ... m.unlock();
+    lock_awaiter lock() noexcept {
+        return lock_awaiter(*this);
+    }
+
+    // auto guard = co_await m.scoped_lock();
+    scoped_lock_awaiter scoped_lock() noexcept {
+        return scoped_lock_awaiter(*this);
+    }
+
+    void unlock() {
+        auto *head = waiters_;
+        if (!head) {
+            auto s = locked_no_waiters;
+            if (state_.compare_exchange_strong(s, not_locked, std::memory_order_release, std::memory_order_relaxed))
+                return;
+            // 有新的等待者：整体取走，状态回到"已加锁、没有等待者"，锁仍然在自己手里
+            s = state_.exchange(locked_no_waiters, std::memory_order_acquire);
+            head = detail::reverse(reinterpret_cast<detail::waiter_node *>(s));
+        }
+        // 锁直接交给head，state_保持加锁
+        waiters_ = head->next;
+        head->resume();
+    }
+
+  private:
+    friend class async_condition_variable;
+
+    // 加锁，拿不到时把w压到等待者栈上；返回true表示已排队，false表示已经拿到锁
+    bool enqueue(detail::waiter_node *w) noexcept {
+        auto s = state_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (s == not_locked) {
+                if (state_.compare_exchange_weak(s, locked_no_waiters, std::memory_order_acquire,
+                                                 std::memory_order_relaxed))
+                    return false;
+            } else {
+                w->next = s == locked_no_waiters ? nullptr : reinterpret_cast<detail::waiter_node *>(s);
+                if (state_.compare_exchange_weak(s, reinterpret_cast<std::uintptr_t>(w), std::memory_order_release,
+                                                 std::memory_order_relaxed))
+                    return true;
+            }
+        }
+    }
+
+    std::atomic<std::uintptr_t> state_{not_locked};
+    detail::waiter_node *waiters_ = nullptr;
+};
+
+inline async_lock_guard::~async_lock_guard() {
+    if (m_)
+        m_->unlock();
+}
+
+// 计数信号量
+// 状态：奇数时(count << 1) | 1表示还有count个名额、没有等待者；非零偶数是等待者栈顶的指针，此时名额为0
+class async_semaphore {
+    class acquire_awaiter {
+      public:
+        explicit acquire_awaiter(async_semaphore &s) noexcept : s_(s) {
+        }
+
+        bool await_ready() noexcept {
+            return s_.try_acquire();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) noexcept {
+            node_.prepare(h);
+            auto s = s_.state_.load(std::memory_order_relaxed);
+            for (;;) {
+                if (s > 1 && (s & 1)) {
+                    if (s_.state_.compare_exchange_weak(s, s - 2, std::memory_order_acquire,
+                                                        std::memory_order_relaxed))
+                        return false;
+                } else {
+                    node_.next = (s & 1) ? nullptr : reinterpret_cast<detail::waiter_node *>(s);
+                    if (s_.state_.compare_exchange_weak(s, reinterpret_cast<std::uintptr_t>(&node_),
+                                                        std::memory_order_release, std::memory_order_relaxed))
+                        return true;
+                }
+            }
+        }
+
+        void await_resume() const noexcept {
+        }
+
+      private:
+        async_semaphore &s_;
+        detail::waiter_node node_;
+    };
+
+  public:
+    explicit async_semaphore(std::ptrdiff_t initial) noexcept
+        : state_((static_cast<std::uintptr_t>(initial) << 1) | 1) {
+    }
+
+    async_semaphore(const async_semaphore &) = delete;
+    async_semaphore &operator=(const async_semaphore &) = delete;
+
+    bool try_acquire() noexcept {
+        auto s = state_.load(std::memory_order_relaxed);
+        while (s > 1 && (s & 1)) {
+            if (state_.compare_exchange_weak(s, s - 2, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    acquire_awaiter acquire() noexcept {
+        return acquire_awaiter(*this);
+    }
+
+    // 有等待者时名额按到达顺序直接交给等待者，不经过计数，后来的acquire不会插队
+    void release(std::ptrdiff_t n = 1) {
+        if (n <= 0)
+            return;
+        detail::dispatch_serialized(releases_, static_cast<std::uint64_t>(n),
+                                    [this](std::uint64_t k) { dispatch(k); });
+    }
+
+  private:
+    // 只由分发者调用；先交给fifo_里的等待者，fifo_空了再把栈整体取走接上，都没有时加到计数上
+    void dispatch(std::uint64_t n) {
+        while (n > 0) {
+            if (fifo_.empty()) {
+                auto s = state_.load(std::memory_order_relaxed);
+                for (;;) {
+                    if (s & 1) {
+                        if (state_.compare_exchange_weak(s, s + 2 * n, std::memory_order_release,
+                                                         std::memory_order_relaxed))
+                            return;
+                    } else if (state_.compare_exchange_weak(s, 1, std::memory_order_acquire,
+                                                            std::memory_order_relaxed)) {
+                        fifo_.append_stack(reinterpret_cast<detail::waiter_node *>(s));
+                        break;
+                    }
+                }
+            }
+            --n;
+            fifo_.pop()->resume();
+        }
+    }
+
+    std::atomic<std::uintptr_t> state_;
+    std::atomic<std::uint64_t> releases_{0};
+    detail::waiter_fifo fifo_;
+};
+
+// 一次性的计数器，减到0时唤醒所有等待者
+// 状态：nullptr，等待者栈顶，或者表示"已完成"的this
+class async_latch {
+    class wait_awaiter {
+      public:
+        explicit wait_awaiter(async_latch &l) noexcept : l_(l) {
+        }
+
+        bool await_ready() const noexcept {
+            return l_.try_wait();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) noexcept {
+            node_.prepare(h);
+            auto *done = l_.done_marker();
+            auto *s = l_.waiters_.load(std::memory_order_acquire);
+            do {
+                if (s == done)
+                    return false;
+                node_.next = s;
+            } while (!l_.waiters_.compare_exchange_weak(s, &node_, std::memory_order_release,
+                                                        std::memory_order_acquire));
+            return true;
+        }
+
+        void await_resume() const noexcept {
+        }
+
+      private:
+        async_latch &l_;
+        detail::waiter_node node_;
+    };
+
+  public:
+    explicit async_latch(std::ptrdiff_t expected) noexcept : count_(expected) {
+        if (expected <= 0)
+            waiters_.store(done_marker(), std::memory_order_relaxed);
+    }
+
+    async_latch(const async_latch &) = delete;
+    async_latch &operator=(const async_latch &) = delete;
+
+    void count_down(std::ptrdiff_t n = 1) {
+        if (count_.fetch_sub(n, std::memory_order_acq_rel) != n)
+            return;
+        auto *s = waiters_.exchange(done_marker(), std::memory_order_acq_rel);
+        for (auto *w = detail::reverse(s); w;) {
+            auto *next = w->next;
+            w->resume();
+            w = next;
+        }
+    }
+
+    bool try_wait() const noexcept {
+        return waiters_.load(std::memory_order_acquire) == done_marker();
+    }
+
+    wait_awaiter wait() noexcept {
+        return wait_awaiter(*this);
+    }
+
+  private:
+    detail::waiter_node *done_marker() const noexcept {
+        return reinterpret_cast<detail::waiter_node *>(const_cast<async_latch *>(this));
+    }
+
+    std::atomic<std::ptrdiff_t> count_;
+    std::atomic<detail::waiter_node *> waiters_{nullptr};
+};
+
+// 配合async_mutex使用的条件变量
+// wait时先把自己挂到条件变量上再解锁，notify后要重新拿到锁才恢复，和std::condition_variable语义一致
+class async_condition_variable {
+    struct cv_node : detail::waiter_node {
+        async_mutex *m = nullptr;
+    };
+
+    class wait_awaiter {
+      public:
+        wait_awaiter(async_condition_variable &cv, async_mutex &m) noexcept : cv_(cv) {
+            node_.m = &m;
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            node_.prepare(h);
+            auto *m = node_.m;
+            auto *s = cv_.waiters_.load(std::memory_order_relaxed);
+            do {
+                node_.next = s;
+            } while (!cv_.waiters_.compare_exchange_weak(s, &node_, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+            // 被notify的协程要等这里解锁后才能拿到锁；解锁后它可能已经恢复，不能再访问this
+            m->unlock();
+        }
+
+        void await_resume() const noexcept {
+        }
+
+      private:
+        async_condition_variable &cv_;
+        cv_node node_;
+    };
+
+    // 被通知的等待者重新排队拿锁，拿到锁后才恢复
+    static void relock(detail::waiter_node *w) {
+        if (!static_cast<cv_node *>(w)->m->enqueue(w))
+            w->resume();
+    }
+
+  public:
+    async_condition_variable() = default;
+    async_condition_variable(const async_condition_variable &) = delete;
+    async_condition_variable &operator=(const async_condition_variable &) = delete;
+
+    // 调用前必须持有m
+    wait_awaiter wait(async_mutex &m) noexcept {
+        return wait_awaiter(*this, m);
+    }
+
+    // 带谓词的版本，返回时持有m且pred()为真
+    template <typename Pred>
+    task<> wait(async_mutex &m, Pred pred) {
+        while (!pred())
+            co_await wait(m);
+    }
+
+    // 唤醒最早挂上来的一个等待者
+    void notify_one() {
+        detail::dispatch_serialized(requests_, 1, [this](std::uint64_t r) { dispatch(r); });
+    }
+
+    void notify_all() {
+        detail::dispatch_serialized(requests_, notify_all_unit, [this](std::uint64_t r) { dispatch(r); });
+    }
+
+  private:
+    // requests_的低32位是notify_one的次数，高位不为0表示有notify_all
+    static constexpr std::uint64_t notify_all_unit = std::uint64_t(1) << 32;
+
+    // 只由分发者调用；没有等待者时通知直接丢弃，和std::condition_variable一样
+    void dispatch(std::uint64_t r) {
+        fifo_.append_stack(waiters_.exchange(nullptr, std::memory_order_acquire));
+        auto n = r >= notify_all_unit ? ~std::uint64_t(0) : r;
+        for (; n > 0 && !fifo_.empty(); --n)
+            relock(fifo_.pop());
+    }
+
+    std::atomic<detail::waiter_node *> waiters_{nullptr};
+    std::atomic<std::uint64_t> requests_{0};
+    detail::waiter_fifo fifo_;
+};
+
+} // namespace coro
@@ -0,0 +1,166 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../common/bench.hpp"
+#include "async_sync.hpp"
+
+using namespace std::chrono_literals;
+
+// 1. 互斥：持锁期间切回调度器，其他协程在锁上排队而不是卡住线程
+coro::detached add(coro::scheduler &s, coro::async_mutex &m, long &counter, int times, std::latch &done) {
+    co_await s.schedule();
+    for (int i = 0; i < times; ++i) {
+        auto guard = co_await m.scoped_lock();
+        long v = counter;
+        co_await s.schedule();
+        counter = v + 1;
+    }
+    done.count_down();
+}
+
+// 2. 信号量：对应03sync_primitive中的counting_semaphore，最多3个同时工作
+coro::detached worker(coro::run_loop &loop, coro::async_semaphore &sem, int id) {
+    co_await loop.schedule();
+    co_await sem.acquire();
+    std::cout << "Coroutine " << id << " working\n";
+    co_await coro::sleep_for(100ms);
+    std::cout << "Coroutine " << id << " done\n";
+    sem.release();
+}
+
+// 3. latch
+coro::detached count_down(coro::run_loop &loop, coro::async_latch &l, int id) {
+    co_await loop.schedule();
+    co_await coro::sleep_for(std::chrono::milliseconds(10 * id));
+    std::cout << "count down: " << id << "\n";
+    l.count_down();
+}
+
+coro::detached wait_latch(coro::run_loop &loop, coro::async_latch &l) {
+    co_await loop.schedule();
+    co_await l.wait();
+    std::cout << "latch released\n";
+}
+
+// 4. 条件变量：对应03sync_primitive中的wait_thread/signal_thread
+coro::detached wait_ready(coro::run_loop &loop, coro::async_mutex &m, coro::async_condition_variable &cv, bool &ready) {
+    co_await loop.schedule();
+    co_await m.lock();
+    co_await cv.wait(m, [&] { return ready; });
+    std::cout << "Ready!\n";
+    m.unlock();
+}
+
+coro::detached signal_ready(coro::run_loop &loop, coro::async_mutex &m, coro::async_condition_variable &cv,
+                            bool &ready) {
+    co_await loop.schedule();
+    co_await coro::sleep_for(100ms);
+    {
+        auto guard = co_await m.scoped_lock();
+        ready = true;
+    }
+    cv.notify_all();
+}
+
+// 5. 性能：持锁期间让出一次，所有竞争者都要在锁上排队
+coro::detached contend(coro::scheduler &s, coro::async_mutex &m, long &counter, int times, std::latch &done) {
+    co_await s.schedule();
+    for (int i = 0; i < times; ++i) {
+        co_await m.lock();
+        ++counter;
+        co_await s.schedule();
+        m.unlock();
+    }
+    done.count_down();
+}
+
+int main(int argc, char *argv[]) {
+    {
+        coro::scheduler s(2);
+        coro::async_mutex m;
+        long counter = 0;
+        std::latch done(4);
+        for (int i = 0; i < 4; ++i)
+            add(s, m, counter, 1000, done);
+        done.wait();
+        std::cout << "counter = " << counter << "\n"; // 4000
+    }
+
+    {
+        coro::run_loop loop;
+        coro::async_semaphore sem(3);
+        for (int i = 0; i < 6; ++i)
+            worker(loop, sem, i);
+        auto ms = time_ms([&] { loop.run(); });
+        std::cout << "6 workers, 3 permits: " << static_cast<int>(ms) << " ms\n"; // ~200
+    }
+
+    {
+        coro::run_loop loop;
+        coro::async_latch l(3);
+        wait_latch(loop, l);
+        for (int i = 1; i <= 3; ++i)
+            count_down(loop, l, i);
+        loop.run();
+    }
+
+    {
+        coro::run_loop loop;
+        coro::async_mutex m;
+        coro::async_condition_variable cv;
+        bool ready = false;
+        wait_ready(loop, m, cv, ready);
+        signal_ready(loop, m, cv, ready);
+        loop.run();
+    }
+
+    {
+        int n = argc > 1 ? std::atoi(argv[1]) : 10'000;
+        int times = argc > 2 ? std::atoi(argv[2]) : 10;
+        long total = static_cast<long>(n) * times;
+        unsigned workers = std::max(2u, std::thread::hardware_concurrency());
+
+        long counter = 0;
+        auto ms = time_ms([&] {
+            coro::scheduler s(workers);
+            coro::async_mutex m;
+            std::latch done(n);
+            for (int i = 0; i < n; ++i)
+                contend(s, m, counter, times, done);
+            done.wait();
+        });
+        std::cout << n << " coroutines on " << workers << " threads, async_mutex: " << ms << " ms, "
+                  << ms * 1e6 / total << " ns per lock (counter " << counter << ")\n";
+
+        counter = 0;
+        std::size_t created = 0;
+        ms = time_ms([&] {
+            std::mutex m;
+            std::vector<std::jthread> ts;
+            ts.reserve(n);
+            try {
+                for (; created < static_cast<std::size_t>(n); ++created) {
+                    ts.emplace_back([&] {
+                        for (int i = 0; i < times; ++i) {
+                            std::lock_guard lg(m);
+                            ++counter;
+                            std::this_thread::yield();
+                        }
+                    });
+                }
+            } catch (const std::system_error &e) {
+                std::cout << "  thread creation failed after " << created << " threads: " << e.what() << "\n";
+            }
+        });
+        std::cout << created << " threads, std::mutex: " << ms << " ms, " << ms * 1e6 / (created * times)
+                  << " ns per lock (counter " << counter << ")\n";
+    }
+    return 0;
+}
@@ -31,6 +31,7 @@ class Awaiter {
     }
 
     // await_suspend() —— 挂起时做什么（通常交给调度器）
+    // 这里直接睡眠再恢复，挂起期间线程被占住；交给调度器的写法见01scheduler
     void await_suspend(std::coroutine_handle<> h) {
         std::cout << "Suspend\n";
         std::this_thread::sleep_for(500ms);
@@ -57,6 +58,7 @@ Awaiter operator co_await(Awaitable a) {
 
 // 2. 协程函数的返回类型必须是包含promise_type类型的类型
 // 编译器生成promise_type对象，初始化协程，执行状态机，自动结果返回给调用者
+// 协程帧默认用全局operator new分配，在promise_type里重载operator new/delete的写法见03frame_pool
 struct Task {
     struct promise_type {
         Task get_return_object() {
@@ -85,6 +87,7 @@ Task foo() {
 // 3) co_await → awaiter 逻辑
 // 4) co_return → promise.return_value()
 // 5) promise.final_suspend()
+// 这里的generator只能产出int，通用的generator<T>见04generator
 struct generator {
     struct promise_type {
         int *ptr_ = nullptr;
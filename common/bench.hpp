@@ -0,0 +1,74 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+// 各目录main.cpp里性能对比共用的测量工具
+// 1) time_ms：执行一次f，返回耗时(毫秒)
+// 2) read_status：从/proc/self/status读取线程数和常驻内存(kB)，仅linux
+// 3) status_sampler：后台定期采样，记录测量期间线程数和常驻内存的峰值
+
+template <typename F>
+double time_ms(F &&f) {
+    auto beg = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - beg).count();
+}
+
+struct proc_status {
+    long threads = 0;
+    long rss_kb = 0;
+};
+
+inline proc_status read_status() {
+    proc_status s;
+    std::ifstream in("/proc/self/status");
+    for (std::string key; in >> key;) {
+        if (key == "Threads:")
+            in >> s.threads;
+        else if (key == "VmRSS:")
+            in >> s.rss_kb;
+        in.ignore(256, '\n');
+    }
+    return s;
+}
+
+class status_sampler {
+  public:
+    explicit status_sampler(std::chrono::milliseconds period = std::chrono::milliseconds(10))
+        : base_(read_status()), peak_threads_(base_.threads), peak_rss_(base_.rss_kb),
+          thread_([this, period](std::stop_token st) {
+              while (!st.stop_requested()) {
+                  auto s = read_status();
+                  peak_threads_ = std::max(peak_threads_.load(), s.threads);
+                  peak_rss_ = std::max(peak_rss_.load(), s.rss_kb);
+                  std::this_thread::sleep_for(period);
+              }
+          }) {
+    }
+
+    // 停止采样并打印峰值；n不为0时再给出平均每个对象占用的内存
+    void report(std::size_t n = 0) {
+        thread_.request_stop();
+        thread_.join();
+        auto rss = std::max(0L, peak_rss_ - base_.rss_kb);
+        std::cout << "  peak threads " << peak_threads_ << " (baseline " << base_.threads << "), peak rss +" << rss
+                  << " kB";
+        if (n)
+            std::cout << " (" << rss * 1024.0 / n << " B each)";
+        std::cout << "\n";
+    }
+
+  private:
+    proc_status base_;
+    std::atomic<long> peak_threads_;
+    std::atomic<long> peak_rss_;
+    std::jthread thread_;
+};
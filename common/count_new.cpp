@@ -0,0 +1,24 @@
+#include "count_new.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// 替换全局operator new/delete
+// new[]的默认实现会转到这里的operator new(size_t)，不需要单独替换；对齐版本(align_val_t)不计数
+std::atomic<long long> new_calls{0};
+
+void *operator new(std::size_t n) {
+    new_calls.fetch_add(1, std::memory_order_relaxed);
+    if (auto *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <atomic>
+
+// 全局operator new的调用次数，用来验证某段代码稳定后不再分配
+// 替换的operator new/delete定义在count_new.cpp里，替换函数在一个程序里只能有一份，所以不放在头文件中
+// 用到它的程序要把count_new.cpp一起编译，例如 g++ -std=c++23 main.cpp ../../common/count_new.cpp
+extern std::atomic<long long> new_calls;
@@ -0,0 +1,16 @@
+#pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 自旋等待时提示CPU降低功耗，并让出流水线给超线程的兄弟核
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}